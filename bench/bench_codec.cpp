@@ -0,0 +1,208 @@
+// Archive size and image load time per entry codec, measured on the images of a puzzle archive.
+// Every entry is re-encoded in memory as raw JPEG, zlib over JPEG and zlib over BGR pixels,
+// then loaded the way the game does: inflate if needed, then decode unless it is raw pixels.
+// A second table compares preview loads at a few target sizes: a full decode followed by the
+// resize against a reduced libjpeg decode (IMREAD_REDUCED_COLOR_2/4/8) followed by the resize.
+//
+//   bench_codec [res/puzzles.dat] [res/puzzles.json] [repetitions]
+
+#include "../src/core/puzzle_archive.hpp"
+
+#include <span>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include <zlib.h>
+#include <nlohmann/json.hpp>
+#include <opencv2/opencv.hpp>
+
+
+namespace {
+
+struct Sample {
+    std::vector<uint8_t> jpeg;
+    int width = 0, height = 0;
+};
+
+struct Codec {
+    const char* name;
+    std::vector<std::vector<uint8_t>> stored;
+    std::function<cv::Mat(const Sample&, const std::vector<uint8_t>&)> load;
+};
+
+// JPEG bytes of an entry in either archive version
+std::vector<uint8_t> read_jpeg(const PuzzleArchive& archive, const nlohmann::json& entry) {
+    uint64_t offset = entry.at("offset").get<uint64_t>();
+    uint64_t length = entry.at("length").get<uint64_t>();
+
+    if (archive.version() >= 2) {
+        int index = entry.value("entry", archive.find_entry(offset));
+        std::vector<uint8_t> buffer;
+        std::span<const uint8_t> bytes = archive.extract(index, buffer);
+        if (index < 0 || archive.entry(index).format != static_cast<uint8_t>(ImageFormat::JPEG)) {
+            return {};
+        }
+        return {bytes.begin(), bytes.end()};
+    }
+
+    std::span<const uint8_t> compressed = archive.view(offset, length);
+    std::vector<uint8_t> jpeg(compressed.size() * 4);
+    while (true) {
+        uLongf size = static_cast<uLongf>(jpeg.size());
+        int z_result = uncompress(jpeg.data(), &size, compressed.data(), static_cast<uLong>(compressed.size()));
+        if (z_result == Z_OK) {
+            jpeg.resize(size);
+            return jpeg;
+        }
+        if (z_result != Z_BUF_ERROR) {
+            return {};
+        }
+        jpeg.resize(jpeg.size() * 2);
+    }
+}
+
+std::vector<uint8_t> deflate(const uint8_t* data, size_t size) {
+    uLongf bound = compressBound(static_cast<uLong>(size));
+    std::vector<uint8_t> out(bound);
+    compress(out.data(), &bound, data, static_cast<uLong>(size));
+    out.resize(bound);
+    return out;
+}
+
+cv::Mat decode(const uint8_t* data, size_t size, int flag = cv::IMREAD_COLOR) {
+    return cv::imdecode(cv::Mat(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data)), flag);
+}
+
+// Same choice as the game: the largest reduction whose output still covers the fitted size
+int reduced_flag(int image_width, int image_height, int width, int height) {
+    constexpr std::pair<int, int> REDUCTIONS[] = {
+        {8, cv::IMREAD_REDUCED_COLOR_8}, {4, cv::IMREAD_REDUCED_COLOR_4}, {2, cv::IMREAD_REDUCED_COLOR_2}
+    };
+    for (const auto& [factor, flag] : REDUCTIONS) {
+        if ((image_width + factor - 1) / factor >= width && (image_height + factor - 1) / factor >= height) {
+            return flag;
+        }
+    }
+    return cv::IMREAD_COLOR;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    std::string dat_path = (argc > 1) ? argv[1] : "res/puzzles.dat";
+    std::string meta_path = (argc > 2) ? argv[2] : "res/puzzles.json";
+    int repetitions = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 5;
+
+    const PuzzleArchive* archive = PuzzleArchive::find(dat_path);
+    std::ifstream in(meta_path);
+    if (!archive || !in) {
+        std::fprintf(stderr, "Failed to open %s or %s\n", dat_path.c_str(), meta_path.c_str());
+        return 1;
+    }
+
+    nlohmann::json meta;
+    in >> meta;
+
+    std::vector<Sample> samples;
+    for (const auto& entry : meta.at("puzzles")) {
+        Sample sample;
+        sample.jpeg = read_jpeg(*archive, entry);
+        cv::Mat image = decode(sample.jpeg.data(), sample.jpeg.size());
+        if (image.empty()) {
+            std::fprintf(stderr, "Skipping unreadable entry %s\n", entry.value("name", "?").c_str());
+            continue;
+        }
+        sample.width = image.cols;
+        sample.height = image.rows;
+        samples.push_back(std::move(sample));
+    }
+
+    std::vector<Codec> codecs;
+    codecs.push_back({"jpeg", {}, [](const Sample&, const std::vector<uint8_t>& stored) {
+        return decode(stored.data(), stored.size());
+    }});
+    codecs.push_back({"zlib-jpeg", {}, [](const Sample& sample, const std::vector<uint8_t>& stored) {
+        std::vector<uint8_t> jpeg(sample.jpeg.size());
+        uLongf size = static_cast<uLongf>(jpeg.size());
+        uncompress(jpeg.data(), &size, stored.data(), static_cast<uLong>(stored.size()));
+        return decode(jpeg.data(), jpeg.size());
+    }});
+    codecs.push_back({"zlib-bgr", {}, [](const Sample& sample, const std::vector<uint8_t>& stored) {
+        cv::Mat image(sample.height, sample.width, CV_8UC3);
+        uLongf size = static_cast<uLongf>(image.total() * image.elemSize());
+        uncompress(image.data, &size, stored.data(), static_cast<uLong>(stored.size()));
+        return image;
+    }});
+
+    for (const auto& sample : samples) {
+        codecs[0].stored.push_back(sample.jpeg);
+        codecs[1].stored.push_back(deflate(sample.jpeg.data(), sample.jpeg.size()));
+
+        cv::Mat image = decode(sample.jpeg.data(), sample.jpeg.size());
+        codecs[2].stored.push_back(deflate(image.data, image.total() * image.elemSize()));
+    }
+
+    std::printf("%zu images from %s, %d repetitions\n", samples.size(), dat_path.c_str(), repetitions);
+    std::printf("%-10s %12s %10s %12s\n", "codec", "archive MB", "vs jpeg", "load ms/img");
+
+    double jpeg_bytes = 0;
+    for (auto& codec : codecs) {
+        double bytes = 0;
+        for (const auto& stored : codec.stored) {
+            bytes += static_cast<double>(stored.size());
+        }
+        if (jpeg_bytes == 0) {
+            jpeg_bytes = bytes;
+        }
+
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) {
+            for (size_t i = 0; i < samples.size(); ++i) {
+                cv::Mat image = codec.load(samples[i], codec.stored[i]);
+                checksum += image.empty() ? 0 : image.data[image.total() * image.elemSize() / 2];
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double per_image_ms = seconds * 1e3 / static_cast<double>(repetitions * samples.size());
+
+        std::printf("%-10s %12.2f %9.2fx %12.2f  (checksum %llu)\n",
+            codec.name, bytes / 1e6, bytes / jpeg_bytes, per_image_ms, static_cast<unsigned long long>(checksum));
+    }
+
+    std::printf("\n%-10s %14s %14s %10s\n", "preview", "full ms/img", "reduced ms/img", "speedup");
+    for (int divisor : {1, 2, 4, 8}) {
+        int max_width = PREVIEW_MAX_WIDTH / divisor, max_height = PREVIEW_MAX_HEIGHT / divisor;
+        double elapsed[2] = {0, 0};
+
+        for (int reduced = 0; reduced < 2; ++reduced) {
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < repetitions; ++r) {
+                for (const auto& sample : samples) {
+                    int width = 0, height = 0;
+                    PuzzleArchive::fit_size(sample.width, sample.height, max_width, max_height, width, height);
+                    int flag = reduced ? reduced_flag(sample.width, sample.height, width, height) : cv::IMREAD_COLOR;
+
+                    cv::Mat image = decode(sample.jpeg.data(), sample.jpeg.size(), flag);
+                    cv::Mat preview;
+                    cv::resize(image, preview, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+                }
+            }
+            elapsed[reduced] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        double images = static_cast<double>(repetitions * samples.size());
+        std::printf("%4dx%-5d %14.2f %14.2f %9.2fx\n", max_width, max_height,
+            elapsed[0] * 1e3 / images, elapsed[1] * 1e3 / images, elapsed[0] / elapsed[1]);
+    }
+
+    return 0;
+}
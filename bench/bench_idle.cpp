@@ -0,0 +1,99 @@
+// CPU time an idle game window costs, in milliseconds of process CPU time per second of wall
+// time. The old 1 ms waitKey poll, which also checked the window and the board every pass, is
+// compared with EventLoop, which sleeps in waitKey one frame at a time. Needs a display; leave
+// the mouse outside the window while it runs.
+//
+//   bench_idle [seconds]
+
+#include "../src/event_loop.hpp"
+#include "../src/core/board.hpp"
+#include "../src/core/shuffler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+namespace {
+
+constexpr const char* BENCH_WIN = "bench_idle";
+
+// User plus system CPU time of the whole process
+double cpu_seconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    auto seconds = [](const FILETIME& t) {
+        return ((static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+template<typename F>
+void measure(const char* name, double seconds, F&& idle) {
+    double cpu_start = cpu_seconds();
+    auto start = std::chrono::steady_clock::now();
+    idle(seconds);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = cpu_seconds() - cpu_start;
+    std::printf("%-26s %8.2f ms CPU per idle second  (%.1f s)\n", name, cpu * 1000.0 / wall, wall);
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? std::stod(argv[1]) : 5.0;
+
+    cv::Mat frame(480, 740, CV_8UC3, cv::Scalar(30, 30, 30));
+    cv::namedWindow(BENCH_WIN, cv::WINDOW_AUTOSIZE);
+    cv::imshow(BENCH_WIN, frame);
+    cv::waitKey(100);
+
+    std::vector<int> perm(25);
+    Shuffler(1).shuffle(perm, 5, 5, Shuffler::default_challenge(5, 5));
+    Board board(perm, 5, 5);
+
+    measure("waitKey(1) poll", seconds, [&](double limit) {
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(limit);
+        int solved = 0;
+        while (std::chrono::steady_clock::now() < end) {
+            cv::waitKey(1);
+            if (cv::getWindowProperty(BENCH_WIN, cv::WND_PROP_VISIBLE) < 1) {
+                break;
+            }
+            solved += board.is_solved();
+        }
+        return solved;
+    });
+
+    measure("EventLoop", seconds, [&](double limit) {
+        EventLoop loop(BENCH_WIN);
+        UiEvent event;
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(limit);
+        while (true) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0 || (loop.next(event, static_cast<int>(remaining)) && event.type == UiEvent::CLOSED)) {
+                break;
+            }
+        }
+    });
+
+    cv::destroyWindow(BENCH_WIN);
+    return 0;
+}
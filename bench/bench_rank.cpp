@@ -0,0 +1,81 @@
+// Throughput of the state identity API on 4x4 boards: Lehmer rank/unrank, full Zobrist
+// hashes and incremental Zobrist updates through Board moves.
+//
+//   bench_rank [iterations]
+
+#include "../src/core/board.hpp"
+#include "../src/core/shuffler.hpp"
+#include "../src/core/permutation.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace {
+
+constexpr int SIZE = 4;
+constexpr int BOARDS = 1024;
+
+template<typename F>
+void measure(const char* name, uint64_t iterations, F&& fn) {
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        sink += fn(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-18s %8.2f M/s  %6.1f ns/op  (checksum %016llx)\n",
+        name, static_cast<double>(iterations) / seconds / 1e6, seconds * 1e9 / static_cast<double>(iterations),
+        static_cast<unsigned long long>(sink));
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    uint64_t iterations = (argc > 1) ? std::stoull(argv[1]) : 20'000'000;
+
+    Shuffler shuffler(1);
+    std::vector<std::vector<int>> boards(BOARDS);
+    std::vector<uint64_t> ranks(BOARDS);
+    for (int i = 0; i < BOARDS; ++i) {
+        shuffler.uniform(boards[i], SIZE, SIZE);
+        ranks[i] = Permutation::rank(boards[i]);
+    }
+
+    for (int i = 0; i < BOARDS; ++i) {
+        if (Permutation::unrank(ranks[i], SIZE * SIZE) != boards[i]) {
+            std::fprintf(stderr, "rank/unrank round trip failed for board %d\n", i);
+            return 1;
+        }
+    }
+
+    std::printf("%dx%d boards, %llu iterations\n", SIZE, SIZE, static_cast<unsigned long long>(iterations));
+
+    measure("rank", iterations, [&](uint64_t i) {
+        return Permutation::rank(boards[i % BOARDS]);
+    });
+
+    int perm[SIZE * SIZE];
+    measure("unrank", iterations, [&](uint64_t i) {
+        Permutation::unrank(ranks[i % BOARDS], SIZE * SIZE, perm);
+        return static_cast<uint64_t>(perm[i % (SIZE * SIZE)]);
+    });
+
+    measure("zobrist full", iterations, [&](uint64_t i) {
+        return Zobrist::hash(boards[i % BOARDS]);
+    });
+
+    Board board(boards[0], SIZE, SIZE);
+    measure("move + zobrist", iterations, [&](uint64_t i) {
+        int cells[4];
+        int count = board.legal_moves(cells);
+        board.move(cells[i % count]);
+        return board.hash();
+    });
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Time to first menu frame. The old sequential startup (parse the catalog, then decode every
+// preview at full resolution in a loop) is compared with the Startup pipeline, which is timed
+// until the preview at last_page is ready: first with an empty thumbnail cache, then warm.
+// Run from the directory containing res/.
+//
+//   bench_startup [repetitions]
+
+#include "../src/main.hpp"
+#include "../src/puzzle.hpp"
+#include "../src/startup.hpp"
+#include "../src/core/startup_trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include <opencv2/opencv.hpp>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+double sequential_ms() {
+    auto start = std::chrono::steady_clock::now();
+
+    auto metas = Puzzle::load_meta(PUZZLE_META_FILE);
+    Puzzle::resolve_entries(PUZZLE_DATA_FILE, metas);
+
+    std::vector<cv::Mat> previews;
+    for (const auto& meta : metas) {
+        previews.push_back(Puzzle::load_image(PUZZLE_DATA_FILE, meta));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Milliseconds until the first preview is ready; the pipeline saves its thumbnail cache on return
+double pipeline_ms(const std::string& thumbnail_file, bool print_trace) {
+    StartupTrace::begin();
+
+    Startup startup;
+    startup.thumbnail_file = thumbnail_file;
+    if (!startup.run()) {
+        return -1;
+    }
+
+    while (!startup.previews->ready(startup.last_page)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    StartupTrace::mark("first preview frame");
+
+    if (print_trace) {
+        StartupTrace::print(std::cout);
+    }
+    return StartupTrace::elapsed_ms("first preview frame");
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    int repetitions = (argc > 1) ? std::max(1, std::stoi(argv[1])) : 5;
+    std::string thumbnail_file = (fs::temp_directory_path() / "revision_bench_previews.bin").string();
+
+    std::vector<double> sequential, cold, warm;
+    for (int r = 0; r < repetitions; ++r) {
+        sequential.push_back(sequential_ms());
+
+        fs::remove(thumbnail_file);
+        cold.push_back(pipeline_ms(thumbnail_file, r == 0));
+        warm.push_back(pipeline_ms(thumbnail_file, false));
+    }
+    fs::remove(thumbnail_file);
+
+    auto median = [](std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    };
+
+    std::printf("\nTime to first frame, median of %d runs (file pages stay in the OS cache)\n", repetitions);
+    std::printf("%-34s %10.2f ms\n", "sequential, every preview decoded", median(sequential));
+    std::printf("%-34s %10.2f ms\n", "pipeline, cold thumbnail cache", median(cold));
+    std::printf("%-34s %10.2f ms\n", "pipeline, warm thumbnail cache", median(warm));
+    return 0;
+}
@@ -1,11 +1,13 @@
 #include "app.hpp"
 
-#include "ft2.hpp"
 #include "main.hpp"
 #include "menu.hpp"
 #include "util.hpp"
 #include "state.hpp"
 #include "puzzle.hpp"
+#include "startup.hpp"
+#include "event_loop.hpp"
+#include "font_manager.hpp"
 
 #include <map>
 #include <random>
@@ -54,7 +56,7 @@ void App::handle_puzzle_solved(MouseState& mouse_state, std::map<std::string, bo
         mouse_state.solved = true;
         solved_map[mouse_state.puzzle_key] = true;
 
-        mouse_state.image_altered = mouse_state.image_original.clone();
+        mouse_state.image_original.copyTo(mouse_state.image_altered);
         draw_text_overlay(mouse_state.image_altered, "Finito!", "Press Escape to return", 56, 36);
         cv::imshow(WIN_NAME, mouse_state.image_altered);
     }
@@ -67,9 +69,10 @@ void App::show_start_screen(const cv::Mat& image_original, int block_width, int
 
     // Overlay centered text
     std::string line1 = "Click to play";
+    std::string line2 = "Press H for a hint";
     int font_height = 48;
     int font_height2 = 28;
-    draw_text_overlay(display, line1, "", font_height, font_height2);
+    draw_text_overlay(display, line1, line2, font_height, font_height2);
 
     cv::namedWindow(WIN_NAME, cv::WINDOW_AUTOSIZE);
     cv::resizeWindow(WIN_NAME, display.cols, display.rows);
@@ -78,53 +81,32 @@ void App::show_start_screen(const cv::Mat& image_original, int block_width, int
 
 bool App::wait_for_mouse_click(const std::string& winname) {
     ClickState state;
-    cv::setMouseCallback(winname, wait_click_callback, &state);
+    EventLoop loop(winname);
 
     while (!state.clicked) {
-        if (cv::waitKey(1) == 27) {
+        UiEvent event;
+        loop.next(event);
+        if (event.type == UiEvent::CLOSED || (event.type == UiEvent::KEY && event.code == 27)) {
             break;
         }
+        if (event.type == UiEvent::MOUSE) {
+            wait_click_callback_impl(event.code, event.x, event.y, event.flags, &state);
+        }
     }
 
-    cv::setMouseCallback(winname, nullptr, nullptr);
     return state.clicked;
 }
 
 void App::draw_text_overlay(cv::Mat& mat, const std::string& line1, const std::string& line2, int font_height1, int font_height2) {
-    int thickness = 2;
-    int font = cv::FONT_HERSHEY_SIMPLEX;
-    int baseline = 0;
-    double scale1 = font_height1 / 32.0, scale2 = font_height2 / 32.0;
-
-    // Calculate text sizes
-    cv::Size sz1 = cv::getTextSize(line1, font, scale1, thickness, &baseline);
-    cv::Size sz2 = cv::getTextSize(line2, font, scale2, thickness, &baseline);
-
-    // Centering calculations
-    int cx = mat.cols / 2;
-    int cy = mat.rows / 2 - (sz1.height + sz2.height) / 2;
-    int box_w = std::max(sz1.width, sz2.width) + 60;
-    int box_h = sz1.height + sz2.height + 60;
-    int box_x = cx - box_w / 2;
-    int box_y = cy - 30;
-
-    // Draw semi-transparent background box
-    cv::Rect box_rect(box_x, box_y, box_w, box_h);
-    cv::Mat overlay = mat.clone();
-    cv::rectangle(overlay, box_rect, cv::Scalar(0, 0, 0, 180), cv::FILLED);
-    cv::addWeighted(overlay, 0.6, mat, 0.4, 0, mat);
-
-    // Render text using FT2TextRenderer
-    FT2TextRenderer ft2(FONT_FILE);
-    int text1_y = cy + sz1.height;
-    int text2_y = text1_y + sz2.height + 10;
-
-    if (!line1.empty()) { 
-        ft2.draw_text(mat, line1, cv::Point(cx, text1_y), cv::Scalar(255, 255,  80), 2, true);
-    }
-    if (!line2.empty()) { 
-        ft2.draw_text(mat, line2, cv::Point(cx, text2_y), cv::Scalar(255, 255, 255), 2, true);
+    // Banners are laid out and rasterized once, then only composited over their own pixels
+    std::string key = line1 + '\n' + line2 + '\n' + std::to_string(font_height1) + 'x' + std::to_string(font_height2);
+    auto it = banners.find(key);
+    if (it == banners.end()) {
+        FT2TextRenderer& ft2 = FontManager::instance().renderer(FONT_FILE, TEXT_FONT_HEIGHT);
+        it = banners.emplace(key, Overlay::make_banner(ft2, line1, line2, font_height1, font_height2)).first;
     }
+
+    Overlay::draw(mat, it->second);
 }
 
 // Callback implementations
@@ -150,9 +132,9 @@ void App::on_mouse_impl(int event, int x, int y, int, void* userdata) {
         Puzzle::swap_block(bx, by, state);
         auto& mat = state.image_altered;
 
-        if (state.perm && Puzzle::is_solved(*state.perm)) {
+        if (state.board && state.board->is_solved()) {
             state.solved = true;
-            mat = state.image_original.clone();
+            state.image_original.copyTo(mat);
             draw_text_overlay(mat, "Finito!", "Press Escape to return", 56, 36);
         }
 
@@ -238,57 +220,21 @@ void App::main_menu_mouse_callback_impl(int event, int x, int y, int flags, void
     }
 }
 
-PuzzleSession App::create_puzzle_session(const PuzzleMeta& meta, const std::map<std::string, bool>& solved_map) {
-    PuzzleSession session{meta};
-    session.puzzle_key = meta.name + "|" + meta.artist;
-    session.solved = solved_map.contains(session.puzzle_key) && solved_map.at(session.puzzle_key);
-
-    session.image_original = Puzzle::load_image(PUZZLE_DATA_FILE, meta);
-    if (session.image_original.empty()) {
-        throw std::runtime_error("Failed to load image for puzzle: " + session.puzzle_key);
-    }
-
-    int n = meta.block_size;
-    session.layout = Puzzle::make_puzzle_layout(session.image_original, n, n);
-    session.blocks = Puzzle::make_blocks(session.layout.cols, session.layout.rows, session.layout.block_width, session.layout.block_height);
-
-    int total = n * n;
-    session.perm.resize(total);
-    Puzzle::shuffle_permutation(session.perm, n, n, session.empty_idx, std::max(6, 2 * (total - 1)));
-
-    return session;
-}
-
 void App::run() {
-    // Load puzzle metadata and previews
-    auto metas = Puzzle::load_meta(PUZZLE_META_FILE);
-    std::vector<cv::Mat> previews;
-
-    for (const auto& meta : metas) {
-        cv::Mat img = Puzzle::load_image(PUZZLE_DATA_FILE, meta);
-
-        if (img.empty()) {
-            std::cerr << "Failed to load preview for: " << meta.name << std::endl;
-            previews.push_back(cv::Mat(128,128,CV_8UC3,cv::Scalar(50,50,50)));
-        }
-        else {
-            previews.push_back(img);
-        }
-    }
-
-    if (previews.empty()) {
-        std::cerr << "No puzzles found in " << PUZZLE_DATA_FILE << std::endl;
+    // Metadata, archive, pattern databases and saved state load concurrently; previews are
+    // decoded on demand and full images only once a puzzle is opened
+    Startup startup;
+    if (!startup.run()) {
         return;
     }
 
-    // Load persistent state (binary)
-    std::map<std::string, bool> solved_map;
-    
-    int last_page = 0;
-    std::vector<int> solved_indices;
-    State::load(solved_indices, last_page);
+    auto& metas = startup.metas;
+    auto& previews = *startup.previews;
+    auto& sessions = *startup.sessions;
+    int last_page = startup.last_page;
 
-    for (int idx : solved_indices) {
+    std::map<std::string, bool> solved_map;
+    for (int idx : startup.solved_indices) {
         if (idx >= 0 && idx < (int)metas.size()) {
             const auto& meta = metas[idx];
             std::string key = meta.name + "|" + meta.artist;
@@ -298,7 +244,7 @@ void App::run() {
 
     while (true) {
         // Show main menu and get puzzle selection
-        int pick = menu ? menu->show(metas, previews, last_page, solved_map) : last_page;
+        int pick = menu ? menu->show(metas, previews, sessions, last_page, solved_map) : last_page;
 
         if (pick < 0 || pick >= static_cast<int>(metas.size())) {
             break;
@@ -316,9 +262,8 @@ void App::run() {
         }
         State::save(save_indices, last_page);
 
-        // Play the selected puzzle
-        const auto& meta = metas[pick];
-        Puzzle puzzle(meta, solved_map);
+        // Play the selected puzzle, usually decoded while its menu page was shown
+        Puzzle puzzle(sessions.take(pick), solved_map);
         puzzle.play(solved_map, last_page, this);
 
         // Save progress after each puzzle (in case solved_map changed)
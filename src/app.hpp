@@ -2,6 +2,10 @@
 
 #include "main.hpp"
 #include "puzzle.hpp"
+#include "overlay.hpp"
+
+#include <map>
+#include <string>
 
 #include <opencv2/opencv.hpp>
 
@@ -35,13 +39,12 @@ private:
     void wait_click_callback_impl(int event, int, int, int, void* userdata);
     void landing_page_mouse_callback_impl(int event, int mx, int my, int, void* userdata);
     void main_menu_mouse_callback_impl(int event, int x, int y, int flags, void* userdata);
-    static PuzzleLayout make_puzzle_layout(const cv::Mat& image, int num_blocks_x, int num_blocks_y);
-    static std::vector<cv::Rect> make_blocks(int cols, int rows, int block_width, int block_height);
-    static std::vector<int> get_empty_neighbors(int empty_idx, int num_blocks_x, int num_blocks_y, const std::vector<int>& perm, bool avoid_zero);
-    PuzzleSession create_puzzle_session(const PuzzleMeta& meta, const std::map<std::string, bool>& solved_map);
 
     // Members
     std::unique_ptr<Menu> menu;
     std::unique_ptr<State> state;
     std::unique_ptr<Puzzle> puzzle;
+
+    // Pre-rendered text banners, keyed by their lines and sizes
+    std::map<std::string, OverlaySprite> banners;
 };
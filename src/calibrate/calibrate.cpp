@@ -0,0 +1,247 @@
+// Measures how hard the shuffled puzzles actually are and grades the catalog.
+//
+//   calibrate [--samples N] [--max-nodes N] [--seed N] [--search-threads N] [--meta res/puzzles.json] [--write]
+//
+// For every grid size used by the catalog, N shuffles are drawn with the game's own
+// shuffler and solved optimally on all cores, one sample per core by default. With
+// --search-threads, samples run one after another and each search uses N threads
+// (0 for all cores), which suits a few very hard boards such as 5x5. The report lists optimal solution lengths,
+// nodes expanded and the time spent in the shuffler. With --write, every entry of the
+// metadata file gets its size's statistics and a difficulty label derived from them.
+// A sample that hits --max-nodes counts as unsolved at the lower bound the search proved, so
+// the move statistics of a size with unsolved samples are lower bounds rather than a biased
+// view of the easier boards only.
+// Sample i is drawn with seed + i, so a run is reproducible regardless of thread count.
+
+#include "../core/solver.hpp"
+#include "../core/shuffler.hpp"
+#include "../core/parallel.hpp"
+#include "../core/pattern_db.hpp"
+
+#include <map>
+#include <set>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+
+namespace {
+
+constexpr const char* DEFAULT_META_FILE = "res/puzzles.json";
+constexpr const char* DEFAULT_PATTERN_DB_DIR = "res";
+
+// Median optimal solution length thresholds for the difficulty labels
+constexpr int EASY_MAX_MOVES = 25;
+constexpr int MEDIUM_MAX_MOVES = 45;
+
+struct SizeStats {
+    int block_size = 0;
+    int samples = 0;
+    int unsolved = 0;               // censored at their proven lower bound in the move statistics
+
+    double mean_moves = 0;
+    int p50_moves = 0, p90_moves = 0, p99_moves = 0, max_moves = 0;
+
+    double mean_nodes = 0;
+    uint64_t p90_nodes = 0, max_nodes = 0;
+
+    double shuffle_us = 0;
+};
+
+template<typename T>
+T percentile(const std::vector<T>& sorted, double p) {
+    if (sorted.empty()) {
+        return T{};
+    }
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+std::string difficulty_label(const SizeStats& stats) {
+    if (stats.p50_moves <= EASY_MAX_MOVES) return "Easy";
+    if (stats.p50_moves <= MEDIUM_MAX_MOVES) return "Medium";
+    return "Hard";
+}
+
+SizeStats calibrate_size(int n, int samples, uint64_t max_nodes, uint64_t seed, int search_threads) {
+    std::vector<int> moves(samples, 0);
+    std::vector<char> solved(samples, 0);
+    std::vector<uint64_t> nodes(samples, 0);
+    std::vector<double> shuffle_us(samples, 0.0);
+
+    SolveOptions options;
+    options.max_nodes = max_nodes;
+    options.threads = search_threads;
+
+    auto run = [&](uint64_t begin, uint64_t end) {
+        std::vector<int> perm(n * n);
+        for (uint64_t i = begin; i < end; ++i) {
+            Shuffler shuffler(seed + i);
+            auto start = std::chrono::steady_clock::now();
+            shuffler.shuffle(perm, n, n, Shuffler::default_challenge(n, n));
+            shuffle_us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            SolveResult result = Solver::solve(perm, n, n, options);
+            nodes[i] = result.nodes;
+            solved[i] = result.solved;
+            moves[i] = result.solved ? static_cast<int>(result.moves.size()) : result.lower_bound;
+        }
+    };
+
+    if (search_threads == 1) {
+        Parallel::for_chunks(static_cast<uint64_t>(samples), 1, run);
+    }
+    else {
+        run(0, static_cast<uint64_t>(samples));
+    }
+
+    SizeStats stats;
+    stats.block_size = n;
+    stats.samples = samples;
+
+    stats.unsolved = static_cast<int>(std::count(solved.begin(), solved.end(), 0));
+
+    std::sort(moves.begin(), moves.end());
+    std::sort(nodes.begin(), nodes.end());
+
+    stats.mean_moves = std::accumulate(moves.begin(), moves.end(), 0.0) / static_cast<double>(samples);
+    stats.p50_moves = percentile(moves, 0.50);
+    stats.p90_moves = percentile(moves, 0.90);
+    stats.p99_moves = percentile(moves, 0.99);
+    stats.max_moves = moves.back();
+
+    stats.mean_nodes = std::accumulate(nodes.begin(), nodes.end(), 0.0) / static_cast<double>(samples);
+    stats.p90_nodes = percentile(nodes, 0.90);
+    stats.max_nodes = nodes.back();
+    stats.shuffle_us = std::accumulate(shuffle_us.begin(), shuffle_us.end(), 0.0) / static_cast<double>(samples);
+    return stats;
+}
+
+nlohmann::ordered_json to_json(const SizeStats& stats) {
+    return {
+        {"samples", stats.samples},
+        {"unsolved", stats.unsolved},
+        {"mean_moves", stats.mean_moves},
+        {"p50_moves", stats.p50_moves},
+        {"p90_moves", stats.p90_moves},
+        {"p99_moves", stats.p99_moves},
+        {"max_moves", stats.max_moves},
+        {"mean_nodes", stats.mean_nodes},
+        {"p90_nodes", stats.p90_nodes},
+        {"max_nodes", stats.max_nodes},
+        {"shuffle_us", stats.shuffle_us},
+    };
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    std::string meta_path = DEFAULT_META_FILE;
+    int samples = 2000;
+    uint64_t max_nodes = 500'000'000;
+    uint64_t seed = 1;
+    int search_threads = 1;
+    bool write = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--samples" && i + 1 < argc) {
+            samples = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--max-nodes" && i + 1 < argc) {
+            max_nodes = std::stoull(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--search-threads" && i + 1 < argc) {
+            search_threads = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--meta" && i + 1 < argc) {
+            meta_path = argv[++i];
+        }
+        else if (arg == "--write") {
+            write = true;
+        }
+        else {
+            std::cerr << "Usage: calibrate [--samples N] [--max-nodes N] [--seed N] [--search-threads N] [--meta path] [--write]" << std::endl;
+            return 1;
+        }
+    }
+
+    PatternDB::load_all(DEFAULT_PATTERN_DB_DIR);
+
+    std::ifstream in(meta_path);
+    if (!in) {
+        std::cerr << "Failed to open JSON file: " << meta_path << std::endl;
+        return 1;
+    }
+
+    nlohmann::ordered_json meta;
+    in >> meta;
+    in.close();
+
+    std::set<int> sizes;
+    for (const auto& entry : meta.at("puzzles")) {
+        sizes.insert(entry.value("block_size", 3));
+    }
+
+    std::cout << "Calibrating " << sizes.size() << " grid size(s), " << samples << " samples each, "
+              << Parallel::thread_count() << " threads" << std::endl;
+    std::printf("%-6s %8s %8s %5s %5s %5s %5s %12s %12s %11s %9s\n",
+        "size", "samples", "mean", "p50", "p90", "p99", "max", "mean nodes", "p90 nodes", "shuffle us", "unsolved");
+
+    std::map<int, SizeStats> results;
+    for (int n : sizes) {
+        auto start = std::chrono::steady_clock::now();
+        SizeStats stats = calibrate_size(n, samples, max_nodes, seed, search_threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%dx%-4d %8d %8.2f %5d %5d %5d %5d %12.0f %12llu %11.2f %9d  (%s, %.1f s)\n",
+            n, n, stats.samples, stats.mean_moves, stats.p50_moves, stats.p90_moves, stats.p99_moves, stats.max_moves,
+            stats.mean_nodes, static_cast<unsigned long long>(stats.p90_nodes), stats.shuffle_us, stats.unsolved,
+            difficulty_label(stats).c_str(), seconds);
+        results[n] = stats;
+
+        if (stats.unsolved > 0) {
+            std::printf("       %d sample(s) hit --max-nodes and count at their lower bound: move statistics are lower bounds\n", stats.unsolved);
+        }
+    }
+
+    if (!write) {
+        return 0;
+    }
+
+    // Lower bounds can only understate a size's difficulty, so only Hard is certain with unsolved samples
+    for (const auto& [n, stats] : results) {
+        if (stats.unsolved > 0 && difficulty_label(stats) != "Hard") {
+            std::cerr << "Not writing " << meta_path << ": " << n << "x" << n << " has " << stats.unsolved
+                      << " unsolved sample(s) and its label may be too easy, raise --max-nodes" << std::endl;
+            return 1;
+        }
+    }
+
+    for (auto& entry : meta.at("puzzles")) {
+        const SizeStats& stats = results.at(entry.value("block_size", 3));
+        entry["difficulty"] = difficulty_label(stats);
+        entry["calibration"] = to_json(stats);
+    }
+
+    std::ofstream out(meta_path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write JSON file: " << meta_path << std::endl;
+        return 1;
+    }
+
+    out << meta.dump(2) << std::endl;
+    std::cout << "Updated " << meta_path << std::endl;
+    return 0;
+}
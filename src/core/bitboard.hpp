@@ -0,0 +1,179 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Flips the BITS wide field number `cell` of a packed word array; a field may straddle two words
+template<int BITS, std::size_t WORDS>
+constexpr void toggle_field(std::array<uint64_t, WORDS>& words, int cell, uint64_t value) {
+    int bit = cell * BITS, shift = bit & 63;
+    words[bit >> 6] ^= value << shift;
+    if constexpr (64 % BITS != 0) {
+        if (shift + BITS > 64) {
+            words[(bit >> 6) + 1] ^= value >> (64 - shift);
+        }
+    }
+}
+
+// Board for a grid size known at compile time, packed into 64-bit words: the tile on each cell
+// takes a nibble up to 16 cells (a 4x4 board is exactly one word) and 5 bits up to 25 cells
+// (two words for 5x5). A move is two xors, and the neighbor and distance tables are constexpr.
+template<int W, int H>
+class BitBoard {
+public:
+    static_assert(W >= 2 && H >= 2 && W * H <= 25, "BitBoard covers grids of up to 25 cells, use Board beyond");
+
+    static constexpr int COLS = W, ROWS = H, SIZE = W * H;
+    static constexpr int BITS = (SIZE <= 16) ? 4 : 5;
+    static constexpr int WORDS = (SIZE * BITS + 63) / 64;
+    static constexpr uint64_t MASK = (1ull << BITS) - 1;
+
+    using Words = std::array<uint64_t, WORDS>;
+
+    static constexpr std::array<CellNeighbors, SIZE> NEIGHBORS = [] {
+        std::array<CellNeighbors, SIZE> table{};
+        for (int cell = 0; cell < SIZE; ++cell) {
+            int x = cell % W, y = cell / W;
+            CellNeighbors& nb = table[cell];
+
+            if (y > 0)     nb.cells[nb.count++] = static_cast<int16_t>(cell - W);
+            if (x > 0)     nb.cells[nb.count++] = static_cast<int16_t>(cell - 1);
+            if (x < W - 1) nb.cells[nb.count++] = static_cast<int16_t>(cell + 1);
+            if (y < H - 1) nb.cells[nb.count++] = static_cast<int16_t>(cell + W);
+        }
+        return table;
+    }();
+
+    // DISTANCE[tile * SIZE + cell], Manhattan distance of the tile from its goal cell (0 for the blank)
+    static constexpr std::array<uint8_t, SIZE * SIZE> DISTANCE = [] {
+        std::array<uint8_t, SIZE * SIZE> table{};
+        for (int tile = 1; tile < SIZE; ++tile) {
+            for (int cell = 0; cell < SIZE; ++cell) {
+                int dx = tile % W - cell % W, dy = tile / W - cell / W;
+                table[tile * SIZE + cell] = static_cast<uint8_t>((dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy));
+            }
+        }
+        return table;
+    }();
+
+    static constexpr Words SOLVED = [] {
+        Words words{};
+        for (int cell = 0; cell < SIZE; ++cell) {
+            toggle_field<BITS>(words, cell, static_cast<uint64_t>(cell));
+        }
+        return words;
+    }();
+
+    BitBoard() : words(SOLVED) {}
+
+    explicit BitBoard(const std::vector<int>& perm) : words{} {
+        for (int cell = 0; cell < SIZE; ++cell) {
+            toggle_field<BITS>(words, cell, static_cast<uint64_t>(perm[cell]));
+            if (perm[cell] == 0) {
+                blank_cell = cell;
+            }
+        }
+    }
+
+    static constexpr int cols() { return W; }
+    static constexpr int rows() { return H; }
+    static constexpr int size() { return SIZE; }
+
+    int tile(int cell) const {
+        int bit = cell * BITS, shift = bit & 63;
+        uint64_t value = words[bit >> 6] >> shift;
+        if constexpr (64 % BITS != 0) {
+            if (shift + BITS > 64) {
+                value |= words[(bit >> 6) + 1] << (64 - shift);
+            }
+        }
+        return static_cast<int>(value & MASK);
+    }
+
+    int blank() const { return blank_cell; }
+    const Words& key() const { return words; }
+
+    bool is_solved() const { return words == SOLVED; }
+
+    bool is_legal(int cell) const {
+        const CellNeighbors& nb = NEIGHBORS[blank_cell];
+        for (int i = 0; i < nb.count; ++i) {
+            if (nb.cells[i] == cell) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int legal_moves(int (&cells)[4]) const {
+        const CellNeighbors& nb = NEIGHBORS[blank_cell];
+        for (int i = 0; i < nb.count; ++i) {
+            cells[i] = nb.cells[i];
+        }
+        return nb.count;
+    }
+
+    bool move(int cell) {
+        if (!is_legal(cell)) {
+            return false;
+        }
+        slide(cell);
+        return true;
+    }
+
+    // Slides the tile at cell into the blank without checking that they are adjacent.
+    // The blank's field is always zero, so the tile is xored into it and out of its old cell.
+    void slide(int cell) {
+        uint64_t value = static_cast<uint64_t>(tile(cell));
+        toggle_field<BITS>(words, blank_cell, value);
+        toggle_field<BITS>(words, cell, value);
+        blank_cell = cell;
+    }
+
+    int manhattan_distance() const {
+        int dist = 0;
+        for (int cell = 0; cell < SIZE; ++cell) {
+            dist += DISTANCE[tile(cell) * SIZE + cell];
+        }
+        return dist;
+    }
+
+    std::vector<int> perm() const {
+        std::vector<int> result(SIZE);
+        for (int cell = 0; cell < SIZE; ++cell) {
+            result[cell] = tile(cell);
+        }
+        return result;
+    }
+
+    bool operator==(const BitBoard& other) const { return words == other.words; }
+
+private:
+    Words words;
+    int blank_cell = 0;
+};
+
+template<typename T>
+inline constexpr bool IS_BIT_BOARD = false;
+
+template<int W, int H>
+inline constexpr bool IS_BIT_BOARD<BitBoard<W, H>> = true;
+
+// Calls fn with the packed board for the common square sizes and with the runtime-sized Board otherwise
+template<typename Fn>
+decltype(auto) visit_board(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y, Fn&& fn) {
+    if (num_blocks_x == num_blocks_y) {
+        switch (num_blocks_x) {
+            case 3: return fn(BitBoard<3, 3>(perm));
+            case 4: return fn(BitBoard<4, 4>(perm));
+            case 5: return fn(BitBoard<5, 5>(perm));
+            default: break;
+        }
+    }
+    return fn(Board(perm, num_blocks_x, num_blocks_y));
+}
@@ -0,0 +1,270 @@
+#include "blend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BLEND_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BLEND_TARGET(isa)
+#else
+#define BLEND_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+
+namespace {
+
+inline uint8_t div255(unsigned x) {
+    return static_cast<uint8_t>((x + 1 + (x >> 8)) >> 8);
+}
+
+void row_scalar(uint8_t* dst, int channels, const uint8_t* coverage, int width, const uint8_t* color) {
+    for (int i = 0; i < width; ++i, dst += channels) {
+        unsigned a = coverage[i];
+        if (a == 0) {
+            continue;
+        }
+        for (int c = 0; c < channels; ++c) {
+            dst[c] = div255(dst[c] * (255 - a) + color[c] * a);
+        }
+    }
+}
+
+void rect_scalar(uint8_t* dst, size_t dst_step, int channels, const uint8_t* coverage, size_t coverage_step,
+                 int width, int height, const uint8_t* color) {
+    for (int row = 0; row < height; ++row) {
+        row_scalar(dst + row * dst_step, channels, coverage + row * coverage_step, width, color);
+    }
+}
+
+#ifdef BLEND_X86
+
+// A group of 16 pixels spans `channels` 16-byte blocks. Block k takes the coverage of pixel
+// (16k + b) / channels for byte b, and color[(16k + b) % channels]; both repeat every group.
+struct Pattern {
+    alignas(16) uint8_t spread[4][16];
+    alignas(16) uint8_t color[4][16];
+
+    Pattern(int channels, const uint8_t* c) {
+        for (int k = 0; k < channels; ++k) {
+            for (int b = 0; b < 16; ++b) {
+                spread[k][b] = static_cast<uint8_t>((16 * k + b) / channels);
+                color[k][b] = c[(16 * k + b) % channels];
+            }
+        }
+    }
+};
+
+BLEND_TARGET("sse4.1")
+inline __m128i div255_epu16(__m128i x) {
+    __m128i one = _mm_set1_epi16(1);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+}
+
+BLEND_TARGET("sse4.1")
+inline __m128i blend16(__m128i d, __m128i a, __m128i c) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i ia = _mm_xor_si128(a, _mm_set1_epi8(-1));   // 255 - a
+
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(ia, zero)),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(a, zero)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(ia, zero)),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(a, zero)));
+    return _mm_packus_epi16(div255_epu16(lo), div255_epu16(hi));
+}
+
+// Blends up to 16 pixels starting at dst; a short tail goes through a zero-padded copy
+BLEND_TARGET("sse4.1")
+inline void group_sse41(uint8_t* dst, int channels, const uint8_t* coverage, int count, const Pattern& p) {
+    alignas(16) uint8_t pixels[64] = {};
+    alignas(16) uint8_t alphas[16] = {};
+    uint8_t* target = dst;
+    __m128i a;
+    if (count == 16) {
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage));
+    }
+    else {
+        std::memcpy(alphas, coverage, count);
+        std::memcpy(pixels, dst, count * channels);
+        a = _mm_load_si128(reinterpret_cast<const __m128i*>(alphas));
+        target = pixels;
+    }
+
+    // Glyph bitmaps are mostly empty margins
+    if (_mm_testz_si128(a, a)) {
+        return;
+    }
+
+    for (int k = 0; k < channels; ++k) {
+        __m128i* block = reinterpret_cast<__m128i*>(target + 16 * k);
+        __m128i ak = _mm_shuffle_epi8(a, _mm_load_si128(reinterpret_cast<const __m128i*>(p.spread[k])));
+        __m128i ck = _mm_load_si128(reinterpret_cast<const __m128i*>(p.color[k]));
+        _mm_storeu_si128(block, blend16(_mm_loadu_si128(block), ak, ck));
+    }
+
+    if (target != dst) {
+        std::memcpy(dst, pixels, count * channels);
+    }
+}
+
+BLEND_TARGET("sse4.1")
+void rect_sse41(uint8_t* dst, size_t dst_step, int channels, const uint8_t* coverage, size_t coverage_step,
+                int width, int height, const uint8_t* color) {
+    Pattern p(channels, color);
+    for (int row = 0; row < height; ++row) {
+        uint8_t* d = dst + row * dst_step;
+        const uint8_t* a = coverage + row * coverage_step;
+        for (int i = 0; i < width; i += 16) {
+            int count = (width - i < 16) ? width - i : 16;
+            group_sse41(d + i * channels, channels, a + i, count, p);
+        }
+    }
+}
+
+BLEND_TARGET("avx2")
+inline __m256i div255_epu16(__m256i x) {
+    __m256i one = _mm256_set1_epi16(1);
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Unpack and pack both work within 128-bit lanes, so the byte order comes back unchanged
+BLEND_TARGET("avx2")
+inline __m256i blend32(__m256i d, __m256i a, __m256i c) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i ia = _mm256_xor_si256(a, _mm256_set1_epi8(-1));
+
+    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(ia, zero)),
+                                  _mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zero), _mm256_unpacklo_epi8(a, zero)));
+    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(ia, zero)),
+                                  _mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zero), _mm256_unpackhi_epi8(a, zero)));
+    return _mm256_packus_epi16(div255_epu16(lo), div255_epu16(hi));
+}
+
+// 32 pixels are 2 * channels blocks: block b spreads coverage half b / channels with pattern b % channels
+BLEND_TARGET("avx2")
+void rect_avx2(uint8_t* dst, size_t dst_step, int channels, const uint8_t* coverage, size_t coverage_step,
+               int width, int height, const uint8_t* color) {
+    Pattern p(channels, color);
+    __m128i spread[4];
+    __m256i colors[4];
+    for (int k = 0; k < channels; ++k) {
+        spread[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(p.spread[k]));
+    }
+    for (int j = 0; j < channels; ++j) {
+        colors[j] = _mm256_set_m128i(_mm_load_si128(reinterpret_cast<const __m128i*>(p.color[(2 * j + 1) % channels])),
+                                     _mm_load_si128(reinterpret_cast<const __m128i*>(p.color[(2 * j) % channels])));
+    }
+
+    for (int row = 0; row < height; ++row) {
+        uint8_t* d = dst + row * dst_step;
+        const uint8_t* a = coverage + row * coverage_step;
+
+        int i = 0;
+        for (; i + 32 <= width; i += 32) {
+            __m256i a32 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            if (_mm256_testz_si256(a32, a32)) {
+                continue;
+            }
+
+            __m128i half[2] = {_mm256_castsi256_si128(a32), _mm256_extracti128_si256(a32, 1)};
+            __m256i* blocks = reinterpret_cast<__m256i*>(d + i * channels);
+            for (int j = 0; j < channels; ++j) {
+                int b0 = 2 * j, b1 = 2 * j + 1;
+                __m256i aj = _mm256_set_m128i(_mm_shuffle_epi8(half[b1 / channels], spread[b1 % channels]),
+                                              _mm_shuffle_epi8(half[b0 / channels], spread[b0 % channels]));
+                _mm256_storeu_si256(blocks + j, blend32(_mm256_loadu_si256(blocks + j), aj, colors[j]));
+            }
+        }
+        for (; i < width; i += 16) {
+            int count = (width - i < 16) ? width - i : 16;
+            group_sse41(d + i * channels, channels, a + i, count, p);
+        }
+    }
+}
+
+struct Features {
+    bool sse41 = false;
+    bool avx2 = false;
+
+    Features() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        sse41 = (info[2] & (1 << 19)) != 0;
+        bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        avx2 = sse41 && os_avx && (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        sse41 = __builtin_cpu_supports("sse4.1");
+        avx2 = sse41 && __builtin_cpu_supports("avx2");
+#endif
+    }
+};
+
+bool cpu_has(Blend::Kernel kernel) {
+    static const Features features;
+    switch (kernel) {
+        case Blend::Kernel::SSE41: return features.sse41;
+        case Blend::Kernel::AVX2: return features.avx2;
+        default: return true;
+    }
+}
+
+#else
+
+bool cpu_has(Blend::Kernel kernel) {
+    return kernel == Blend::Kernel::SCALAR;
+}
+
+#endif
+
+} // namespace
+
+
+Blend::Kernel Blend::best() {
+    static const Kernel kernel = supported(Kernel::AVX2) ? Kernel::AVX2 : supported(Kernel::SSE41) ? Kernel::SSE41 : Kernel::SCALAR;
+    return kernel;
+}
+
+bool Blend::supported(Kernel kernel) {
+    return cpu_has(kernel);
+}
+
+const char* Blend::name(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SSE41: return "sse4.1";
+        case Kernel::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void Blend::coverage(uint8_t* dst, size_t dst_step, int channels, const uint8_t* coverage, size_t coverage_step,
+                     int width, int height, const uint8_t* color) {
+    Blend::coverage(best(), dst, dst_step, channels, coverage, coverage_step, width, height, color);
+}
+
+void Blend::coverage(Kernel kernel, uint8_t* dst, size_t dst_step, int channels, const uint8_t* coverage, size_t coverage_step,
+                     int width, int height, const uint8_t* color) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+#ifdef BLEND_X86
+    if (channels == 3 || channels == 4) {
+        if (kernel == Kernel::AVX2 && supported(Kernel::AVX2)) {
+            rect_avx2(dst, dst_step, channels, coverage, coverage_step, width, height, color);
+            return;
+        }
+        if (kernel != Kernel::SCALAR && supported(Kernel::SSE41)) {
+            rect_sse41(dst, dst_step, channels, coverage, coverage_step, width, height, color);
+            return;
+        }
+    }
+#endif
+    rect_scalar(dst, dst_step, channels, coverage, coverage_step, width, height, color);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Coverage blending of a solid color into interleaved 8-bit pixels, as used to composite
+// anti-aliased glyphs: dst = (dst * (255 - a) + color * a) / 255 per channel, truncated exactly.
+// The vector kernels use x / 255 == (x + 1 + (x >> 8)) >> 8, which holds for every x <= 255 * 255,
+// so all kernels produce identical bytes.
+class Blend {
+public:
+    enum class Kernel { SCALAR, SSE41, AVX2 };
+
+    // Fastest kernel this CPU supports, detected once
+    static Kernel best();
+    static bool supported(Kernel kernel);
+    static const char* name(Kernel kernel);
+
+    // Blends a width x height coverage rectangle into dst, both already clipped to the image.
+    // Steps are in bytes, color holds `channels` bytes; only 3 and 4 channels are vectorized.
+    static void coverage(uint8_t* dst, size_t dst_step, int channels,
+                         const uint8_t* coverage, size_t coverage_step,
+                         int width, int height, const uint8_t* color);
+    static void coverage(Kernel kernel, uint8_t* dst, size_t dst_step, int channels,
+                         const uint8_t* coverage, size_t coverage_step,
+                         int width, int height, const uint8_t* color);
+};
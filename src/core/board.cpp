@@ -0,0 +1,107 @@
+#include "board.hpp"
+
+#include "permutation.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <numeric>
+#include <algorithm>
+
+
+Board::Board(int num_blocks_x, int num_blocks_y) : num_blocks_x(num_blocks_x), num_blocks_y(num_blocks_y), tiles(num_blocks_x * num_blocks_y) {
+    std::iota(tiles.begin(), tiles.end(), 0);
+    zobrist = Zobrist::hash(tiles);
+}
+
+Board::Board(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) : num_blocks_x(num_blocks_x), num_blocks_y(num_blocks_y), tiles(perm) {
+    blank_cell = static_cast<int>(std::find(tiles.begin(), tiles.end(), 0) - tiles.begin());
+
+    for (int cell = 0; cell < size(); ++cell) {
+        misplaced += (tiles[cell] != 0 && tiles[cell] != cell);
+    }
+    zobrist = Zobrist::hash(tiles);
+}
+
+bool Board::is_legal(int cell) const {
+    if (cell < 0 || cell >= size()) {
+        return false;
+    }
+
+    int dx = std::abs(cell % num_blocks_x - blank_cell % num_blocks_x);
+    int dy = std::abs(cell / num_blocks_x - blank_cell / num_blocks_x);
+    return dx + dy == 1;
+}
+
+int Board::legal_moves(int (&cells)[4]) const {
+    int x = blank_cell % num_blocks_x, y = blank_cell / num_blocks_x, count = 0;
+
+    if (y > 0)                cells[count++] = blank_cell - num_blocks_x;
+    if (x > 0)                cells[count++] = blank_cell - 1;
+    if (x < num_blocks_x - 1) cells[count++] = blank_cell + 1;
+    if (y < num_blocks_y - 1) cells[count++] = blank_cell + num_blocks_x;
+
+    return count;
+}
+
+std::vector<CellNeighbors> Board::neighbor_table(int num_blocks_x, int num_blocks_y) {
+    std::vector<CellNeighbors> table(num_blocks_x * num_blocks_y);
+    for (int cell = 0; cell < static_cast<int>(table.size()); ++cell) {
+        int x = cell % num_blocks_x, y = cell / num_blocks_x;
+        CellNeighbors& nb = table[cell];
+
+        if (y > 0)                nb.cells[nb.count++] = static_cast<int16_t>(cell - num_blocks_x);
+        if (x > 0)                nb.cells[nb.count++] = static_cast<int16_t>(cell - 1);
+        if (x < num_blocks_x - 1) nb.cells[nb.count++] = static_cast<int16_t>(cell + 1);
+        if (y < num_blocks_y - 1) nb.cells[nb.count++] = static_cast<int16_t>(cell + num_blocks_x);
+    }
+    return table;
+}
+
+bool Board::move(int cell) {
+    if (!is_legal(cell)) {
+        return false;
+    }
+
+    slide(cell);
+    return true;
+}
+
+void Board::slide(int cell) {
+    int tile = tiles[cell];
+    misplaced += (tile != blank_cell) - (tile != cell);
+    zobrist = Zobrist::slide(zobrist, tile, cell, blank_cell);
+
+    tiles[blank_cell] = tile;
+    tiles[cell] = 0;
+    blank_cell = cell;
+}
+
+uint64_t Board::rank() const {
+    return Permutation::rank(tiles);
+}
+
+int Board::manhattan_distance() const {
+    return manhattan_distance(tiles, num_blocks_x, num_blocks_y);
+}
+
+bool Board::is_solved(const std::vector<int>& perm) {
+    for (size_t i = 1; i < perm.size(); ++i) {
+        if ((int)i != perm[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Board::manhattan_distance(const std::vector<int>& perm, int num_blocks_x, int /*num_blocks_y*/) {
+    int dist = 0;
+    for (size_t idx = 0; idx < perm.size(); ++idx) {
+        if (perm[idx] == 0) {
+            continue;
+        }
+
+        dist += std::abs(static_cast<int>(idx % num_blocks_x) - perm[idx] % num_blocks_x);
+        dist += std::abs(static_cast<int>(idx / num_blocks_x) - perm[idx] / num_blocks_x);
+    }
+    return dist;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Cells adjacent to a cell, in up, left, right, down order
+struct CellNeighbors {
+    int count = 0;
+    int16_t cells[4] = {};
+};
+
+// Pure sliding puzzle model: perm[cell] is the tile on that cell, tile `0` is the blank,
+// and the puzzle is solved when every tile sits on its own cell (blank at the top-left).
+class Board {
+public:
+    Board() = default;
+    Board(int num_blocks_x, int num_blocks_y);
+    Board(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+
+    int cols() const { return num_blocks_x; }
+    int rows() const { return num_blocks_y; }
+    int size() const { return static_cast<int>(tiles.size()); }
+
+    const std::vector<int>& perm() const { return tiles; }
+    int tile(int cell) const { return tiles[cell]; }
+    int blank() const { return blank_cell; }
+
+    // Constant time, the number of misplaced tiles is kept up to date by move()
+    bool is_solved() const { return misplaced == 0; }
+
+    // Zobrist hash, updated incrementally by every move
+    uint64_t hash() const { return zobrist; }
+    // Lehmer rank of the permutation, a canonical identity for boards of up to Permutation::MAX_RANK_SIZE
+    // cells; throws std::out_of_range for larger boards, which hash() covers instead
+    uint64_t rank() const;
+
+    bool is_legal(int cell) const;
+    int legal_moves(int (&cells)[4]) const;
+
+    // Slides the tile at cell into the blank; false (and no change) if it is not adjacent
+    bool move(int cell);
+    // Same without the adjacency check, for callers that only generate legal moves
+    void slide(int cell);
+
+    int manhattan_distance() const;
+
+    static bool is_solved(const std::vector<int>& perm);
+    static int manhattan_distance(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+    static std::vector<CellNeighbors> neighbor_table(int num_blocks_x, int num_blocks_y);
+
+private:
+    int num_blocks_x = 0, num_blocks_y = 0;
+    int blank_cell = 0;
+    int misplaced = 0;      // non-blank tiles away from their own cell
+    uint64_t zobrist = 0;
+    std::vector<int> tiles;
+};
@@ -0,0 +1,129 @@
+#include "distance_table.hpp"
+
+#include "permutation.hpp"
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+
+namespace {
+
+constexpr uint8_t UNREACHABLE = 0xFF;
+
+using Cells = std::array<int, DISTANCE_TABLE_MAX_BLOCKS>;
+
+template<typename F>
+void for_each_neighbor(int blank, int cols, int rows, F&& fn) {
+    int x = blank % cols, y = blank / cols;
+    if (y > 0)        fn(blank - cols);
+    if (x > 0)        fn(blank - 1);
+    if (x < cols - 1) fn(blank + 1);
+    if (y < rows - 1) fn(blank + cols);
+}
+
+} // namespace
+
+
+DistanceTable::DistanceTable(int num_blocks_x, int num_blocks_y) : cols(num_blocks_x), rows(num_blocks_y) {
+    int n = cols * rows;
+    uint32_t states = static_cast<uint32_t>(Permutation::factorial(n));
+    table.assign(states, UNREACHABLE);
+
+    // Breadth-first search from the solved permutation; the ranks of each level double as the queue
+    Cells perm{};
+    std::iota(perm.begin(), perm.begin() + n, 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(states / 2);
+    queue.push_back(static_cast<uint32_t>(Permutation::rank(perm.data(), n)));
+    table[queue.front()] = 0;
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t current = queue[head];
+        uint8_t next_distance = static_cast<uint8_t>(table[current] + 1);
+        Permutation::unrank(current, n, perm.data());
+        int blank = static_cast<int>(std::find(perm.begin(), perm.begin() + n, 0) - perm.begin());
+
+        for_each_neighbor(blank, cols, rows, [&](int cell) {
+            std::swap(perm[blank], perm[cell]);
+            uint32_t next = static_cast<uint32_t>(Permutation::rank(perm.data(), n));
+            if (table[next] == UNREACHABLE) {
+                table[next] = next_distance;
+                queue.push_back(next);
+            }
+            std::swap(perm[blank], perm[cell]);
+        });
+    }
+}
+
+const DistanceTable* DistanceTable::find(int num_blocks_x, int num_blocks_y) {
+    if (num_blocks_x < 1 || num_blocks_y < 1 || num_blocks_x * num_blocks_y > DISTANCE_TABLE_MAX_BLOCKS) {
+        return nullptr;
+    }
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<DistanceTable>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = tables[{num_blocks_x, num_blocks_y}];
+    if (!slot) {
+        slot.reset(new DistanceTable(num_blocks_x, num_blocks_y));
+    }
+    return slot.get();
+}
+
+uint32_t DistanceTable::rank(const std::vector<int>& perm) {
+    return static_cast<uint32_t>(Permutation::rank(perm));
+}
+
+int DistanceTable::distance(const std::vector<int>& perm) const {
+    if (static_cast<int>(perm.size()) != cols * rows) {
+        return -1;
+    }
+
+    uint8_t d = table[rank(perm)];
+    return d == UNREACHABLE ? -1 : d;
+}
+
+int DistanceTable::next_move(const std::vector<int>& perm) const {
+    int d = distance(perm);
+    if (d <= 0) {
+        return -1;
+    }
+
+    Cells cells{};
+    int n = cols * rows;
+    std::copy(perm.begin(), perm.end(), cells.begin());
+    int blank = static_cast<int>(std::find(perm.begin(), perm.end(), 0) - perm.begin());
+    int best = -1;
+
+    // Exactly the neighbors one step closer to the goal lie on an optimal path
+    for_each_neighbor(blank, cols, rows, [&](int cell) {
+        std::swap(cells[blank], cells[cell]);
+        if (best < 0 && table[Permutation::rank(cells.data(), n)] == d - 1) {
+            best = cell;
+        }
+        std::swap(cells[blank], cells[cell]);
+    });
+
+    return best;
+}
+
+std::vector<int> DistanceTable::solve(const std::vector<int>& perm) const {
+    std::vector<int> moves;
+    std::vector<int> current = perm;
+    int blank = static_cast<int>(std::find(current.begin(), current.end(), 0) - current.begin());
+
+    for (int cell = next_move(current); cell >= 0; cell = next_move(current)) {
+        std::swap(current[blank], current[cell]);
+        moves.push_back(cell);
+        blank = cell;
+    }
+
+    return moves;
+}
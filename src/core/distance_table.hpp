@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+constexpr int DISTANCE_TABLE_MAX_BLOCKS = 9;
+
+// Exact distance to the solved permutation for every state of a small board (up to 3x3),
+// one byte per permutation rank. 3x3 boards have 9! / 2 = 181,440 reachable states.
+class DistanceTable {
+public:
+    // Builds the table for the board size on first use; nullptr if the board is too large
+    static const DistanceTable* find(int num_blocks_x, int num_blocks_y);
+
+    // Optimal number of moves, -1 if the permutation is not reachable
+    int distance(const std::vector<int>& perm) const;
+
+    // Board index of the tile to slide into the blank next, -1 if solved or unreachable
+    int next_move(const std::vector<int>& perm) const;
+
+    std::vector<int> solve(const std::vector<int>& perm) const;
+
+    static uint32_t rank(const std::vector<int>& perm);
+
+private:
+    DistanceTable(int num_blocks_x, int num_blocks_y);
+
+    int cols, rows;
+    std::vector<uint8_t> table;
+};
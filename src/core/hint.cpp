@@ -0,0 +1,108 @@
+#include "hint.hpp"
+
+#include "solver.hpp"
+
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+
+namespace {
+
+// True if sliding the tile at `cell` into the blank of `from` yields `to`
+bool follows(const std::vector<int>& from, int cell, const std::vector<int>& to) {
+    if (from.size() != to.size() || cell < 0 || cell >= static_cast<int>(from.size())) {
+        return false;
+    }
+
+    int blank = static_cast<int>(std::find(from.begin(), from.end(), 0) - from.begin());
+    for (size_t i = 0; i < from.size(); ++i) {
+        int expected = (static_cast<int>(i) == blank) ? from[cell] : (static_cast<int>(i) == cell) ? 0 : from[i];
+        if (to[i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+
+HintEngine::HintEngine(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) : num_blocks_x(num_blocks_x), num_blocks_y(num_blocks_y) {
+    job = perm;
+    has_job = true;
+    worker = std::thread(&HintEngine::worker_loop, this);
+}
+
+HintEngine::~HintEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    cancel = true;
+    wake.notify_all();
+    worker.join();
+}
+
+void HintEngine::update(const std::vector<int>& perm) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+
+    // The player followed the hint: the rest of the optimal path is still optimal, no search needed
+    if (!known_path.empty() && known_generation + 1 == generation && follows(known_perm, known_path.front(), perm)) {
+        known_perm = perm;
+        known_path.erase(known_path.begin());
+        known_bound = static_cast<int>(known_path.size());
+        known_generation = generation;
+        next_hint = known_path.empty() ? -1 : known_path.front();
+        return;
+    }
+
+    job = perm;
+    has_job = true;
+    next_hint = -1;
+    cancel = true;
+    wake.notify_one();
+}
+
+void HintEngine::worker_loop() {
+    while (true) {
+        std::vector<int> perm;
+        SolveOptions options;
+        uint64_t job_generation = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stop || has_job; });
+            if (stop) {
+                return;
+            }
+
+            perm = std::move(job);
+            has_job = false;
+            cancel = false;
+            job_generation = generation;
+
+            // A single move changes the optimal length by exactly one, so the last proven bound
+            // minus the moves made since is still a lower bound and skips the cheap iterations
+            if (!known_perm.empty()) {
+                options.min_bound = known_bound - static_cast<int>(job_generation - known_generation);
+            }
+            options.cancel = &cancel;
+        }
+
+        SolveResult result = Solver::solve(perm, num_blocks_x, num_blocks_y, options);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        known_perm = std::move(perm);
+        known_bound = result.lower_bound;
+        known_generation = job_generation;
+        known_path = result.solved ? std::move(result.moves) : std::vector<int>{};
+
+        if (result.solved && !has_job && generation == job_generation) {
+            next_hint = known_path.empty() ? -1 : known_path.front();
+        }
+    }
+}
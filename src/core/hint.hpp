@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+
+// Searches the next optimal move on a worker thread. Every update() cancels the
+// search in flight and restarts it from the new permutation, so the UI never waits.
+class HintEngine {
+public:
+    HintEngine(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+    ~HintEngine();
+
+    HintEngine(const HintEngine&) = delete;
+    HintEngine& operator=(const HintEngine&) = delete;
+
+    // Call after every move with the new permutation
+    void update(const std::vector<int>& perm);
+
+    // Board index of the tile to slide into the blank next, -1 while searching or when solved
+    int hint() const { return next_hint.load(std::memory_order_acquire); }
+
+private:
+    void worker_loop();
+
+    int num_blocks_x, num_blocks_y;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::atomic<bool> cancel{false};
+    std::atomic<int> next_hint{-1};
+
+    bool stop = false;
+    bool has_job = false;
+    std::vector<int> job;
+    uint64_t generation = 0;        // number of moves seen so far
+
+    // Last finished (or cancelled) search: its permutation, path and proven lower bound
+    std::vector<int> known_perm;
+    std::vector<int> known_path;
+    int known_bound = 0;
+    uint64_t known_generation = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+class Parallel {
+public:
+    static unsigned thread_count() {
+        unsigned forced = forced_threads.load(std::memory_order_relaxed);
+        return forced ? forced : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Runs every later for_chunks on exactly count threads, 0 for one per core; lets tests
+    // compare a parallel result with the serial one on any machine
+    static void set_thread_count(unsigned count) {
+        forced_threads.store(count, std::memory_order_relaxed);
+    }
+
+    // Calls fn(begin, end) for consecutive chunks of [0, count) on every core
+    template<typename F>
+    static void for_chunks(uint64_t count, uint64_t chunk, F&& fn) {
+        std::atomic<uint64_t> next{0};
+        auto worker = [&]() {
+            while (true) {
+                uint64_t begin = next.fetch_add(chunk);
+                if (begin >= count) {
+                    break;
+                }
+                fn(begin, std::min(count, begin + chunk));
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < thread_count(); ++i) {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+private:
+    static inline std::atomic<unsigned> forced_threads{0};
+};
@@ -0,0 +1,350 @@
+#include "pattern_db.hpp"
+
+#include "parallel.hpp"
+
+#include <bit>
+#include <map>
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+
+
+namespace {
+
+constexpr char PATTERN_DB_MAGIC[4] = {'R', 'V', 'P', 'D'};
+constexpr uint8_t UNSEEN = 0xFF;
+constexpr uint8_t EXPANDED = 0x80;
+constexpr uint64_t BFS_CHUNK = 1 << 16;
+
+std::map<std::pair<int, int>, PatternDB>& registry() {
+    static std::map<std::pair<int, int>, PatternDB> dbs;
+    return dbs;
+}
+
+// n! / (n - k)!
+uint64_t falling_factorial(int n, int k) {
+    uint64_t result = 1;
+    for (int i = 0; i < k; ++i) {
+        result *= static_cast<uint64_t>(n - i);
+    }
+    return result;
+}
+
+// Mixed-radix rank of k distinct cells out of n
+uint64_t rank_cells(const int* cells, int k, int n) {
+    uint64_t used = 0, idx = 0;
+    for (int i = 0; i < k; ++i) {
+        int cell = cells[i];
+        int r = cell - std::popcount(used & ((uint64_t(1) << cell) - 1));
+        idx = idx * static_cast<uint64_t>(n - i) + static_cast<uint64_t>(r);
+        used |= uint64_t(1) << cell;
+    }
+    return idx;
+}
+
+void unrank_cells(uint64_t idx, int k, int n, int* cells) {
+    std::array<int, PATTERN_DB_MAX_TILES + 1> digits{};
+    for (int i = k - 1; i >= 0; --i) {
+        uint64_t radix = static_cast<uint64_t>(n - i);
+        digits[i] = static_cast<int>(idx % radix);
+        idx /= radix;
+    }
+
+    uint64_t used = 0;
+    for (int i = 0; i < k; ++i) {
+        // Select the digits[i]-th free cell
+        int r = digits[i], cell = 0;
+        for (;; ++cell) {
+            if (!(used & (uint64_t(1) << cell)) && r-- == 0) {
+                break;
+            }
+        }
+        cells[i] = cell;
+        used |= uint64_t(1) << cell;
+    }
+}
+
+bool claim(uint8_t& slot, uint8_t expected, uint8_t desired) {
+    return std::atomic_ref<uint8_t>(slot).compare_exchange_strong(expected, desired, std::memory_order_relaxed);
+}
+
+uint8_t peek(uint8_t& slot) {
+    return std::atomic_ref<uint8_t>(slot).load(std::memory_order_relaxed);
+}
+
+// Distances of every (pattern cells, blank cell) state; moves of non-pattern tiles are free
+std::vector<uint8_t> search_pattern(const std::vector<int>& tiles, int cols, int rows) {
+    int n = cols * rows;
+    int k = static_cast<int>(tiles.size());
+    uint64_t states = falling_factorial(n, k + 1);
+    std::vector<uint8_t> dist(states, UNSEEN);
+
+    std::vector<std::array<int, 4>> neighbors(n);
+    for (int cell = 0; cell < n; ++cell) {
+        int x = cell % cols, y = cell / cols, c = 0;
+        neighbors[cell].fill(-1);
+        if (y > 0)        neighbors[cell][c++] = cell - cols;
+        if (x > 0)        neighbors[cell][c++] = cell - 1;
+        if (x < cols - 1) neighbors[cell][c++] = cell + 1;
+        if (y < rows - 1) neighbors[cell][c++] = cell + cols;
+    }
+
+    std::array<int, PATTERN_DB_MAX_TILES + 1> start{};
+    std::copy(tiles.begin(), tiles.end(), start.begin());
+    start[k] = 0;
+    dist[rank_cells(start.data(), k + 1, n)] = 0;
+
+    // Small searches still split into enough chunks to keep every thread busy
+    uint64_t chunk = std::clamp<uint64_t>(states / (Parallel::thread_count() * 16ull), 1024, BFS_CHUNK);
+
+    for (int depth = 0; depth < EXPANDED - 1; ++depth) {
+        std::atomic<uint64_t> claimed{0};
+        uint8_t level = static_cast<uint8_t>(depth);
+        uint8_t done = static_cast<uint8_t>(depth) | EXPANDED;
+
+        Parallel::for_chunks(states, chunk, [&](uint64_t begin, uint64_t end) {
+            std::vector<uint64_t> stack;
+            std::array<int, PATTERN_DB_MAX_TILES + 1> cells{};
+            std::array<int, 64> occupant{};
+            uint64_t local = 0;
+
+            for (uint64_t i = begin; i < end; ++i) {
+                if (peek(dist[i]) != level || !claim(dist[i], level, done)) {
+                    continue;
+                }
+
+                stack.push_back(i);
+                while (!stack.empty()) {
+                    uint64_t s = stack.back();
+                    stack.pop_back();
+                    ++local;
+
+                    unrank_cells(s, k + 1, n, cells.data());
+                    std::fill(occupant.begin(), occupant.begin() + n, -1);
+                    for (int j = 0; j < k; ++j) {
+                        occupant[cells[j]] = j;
+                    }
+
+                    int blank = cells[k];
+                    for (int next : neighbors[blank]) {
+                        if (next < 0) {
+                            break;
+                        }
+
+                        int j = occupant[next];
+                        cells[k] = next;
+
+                        if (j >= 0) {
+                            // Moving a pattern tile costs one move
+                            cells[j] = blank;
+                            uint64_t t = rank_cells(cells.data(), k + 1, n);
+                            claim(dist[t], UNSEEN, static_cast<uint8_t>(depth + 1));
+                            cells[j] = next;
+                        }
+                        else {
+                            // Moving any other tile is free: flood the blank's region at this depth
+                            // A pattern-tile move on another thread may set the state to depth + 1 between
+                            // the load and the exchange; retry with the value the failed exchange reloaded
+                            uint64_t t = rank_cells(cells.data(), k + 1, n);
+                            std::atomic_ref<uint8_t> slot(dist[t]);
+                            uint8_t v = slot.load(std::memory_order_relaxed);
+                            while (v == UNSEEN || v == level || v == level + 1) {
+                                if (slot.compare_exchange_strong(v, done, std::memory_order_relaxed)) {
+                                    stack.push_back(t);
+                                    break;
+                                }
+                            }
+                        }
+                        cells[k] = blank;
+                    }
+                }
+            }
+
+            claimed += local;
+        });
+
+        if (claimed == 0) {
+            break;
+        }
+    }
+
+    return dist;
+}
+
+} // namespace
+
+
+bool PatternDB::open(const std::string& path) {
+    if (!file.open(path) || file.size() < sizeof(PatternDBHeader)) {
+        return false;
+    }
+
+    header = reinterpret_cast<const PatternDBHeader*>(file.data());
+    if (std::memcmp(header->magic, PATTERN_DB_MAGIC, 4) != 0 || header->version != PATTERN_DB_VERSION) {
+        std::cerr << "Unsupported pattern database: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    int n = header->cols * header->rows;
+    size_t table_end = sizeof(PatternDBHeader) + header->pattern_count * sizeof(PatternDBPattern);
+    if (n > 64 || table_end > file.size()) {
+        file.close();
+        return false;
+    }
+
+    patterns = reinterpret_cast<const PatternDBPattern*>(file.data() + sizeof(PatternDBHeader));
+    tables.clear();
+    pattern_of.assign(n, -1);
+
+    for (uint32_t p = 0; p < header->pattern_count; ++p) {
+        const auto& pat = patterns[p];
+        if (pat.tile_count > PATTERN_DB_MAX_TILES || pat.entries != falling_factorial(n, pat.tile_count) ||
+            pat.offset + (pat.entries + 1) / 2 > file.size()) {
+            std::cerr << "Corrupt pattern database: " << path << std::endl;
+            file.close();
+            return false;
+        }
+
+        for (int i = 0; i < pat.tile_count; ++i) {
+            if (pat.tiles[i] == 0 || pat.tiles[i] >= n) {
+                file.close();
+                return false;
+            }
+            pattern_of[pat.tiles[i]] = static_cast<int>(p);
+        }
+        tables.push_back(file.data() + pat.offset);
+    }
+
+    return true;
+}
+
+uint64_t PatternDB::index(int pattern, const int* position) const {
+    const auto& pat = patterns[pattern];
+    std::array<int, PATTERN_DB_MAX_TILES> cells{};
+    for (int i = 0; i < pat.tile_count; ++i) {
+        cells[i] = position[pat.tiles[i]];
+    }
+    return rank_cells(cells.data(), pat.tile_count, header->cols * header->rows);
+}
+
+void PatternDB::load_all(const std::string& dir) {
+    for (int size : {4, 5}) {
+        std::string path = dir + "/" + file_name(size, size);
+
+        PatternDB db;
+        if (db.open(path)) {
+            registry().insert_or_assign({size, size}, std::move(db));
+        }
+    }
+}
+
+const PatternDB* PatternDB::find(int num_blocks_x, int num_blocks_y) {
+    auto& dbs = registry();
+    auto it = dbs.find({num_blocks_x, num_blocks_y});
+    return it != dbs.end() ? &it->second : nullptr;
+}
+
+std::string PatternDB::file_name(int num_blocks_x, int num_blocks_y) {
+    return "pattern_" + std::to_string(num_blocks_x) + "x" + std::to_string(num_blocks_y) + ".pdb";
+}
+
+std::vector<std::vector<int>> PatternDB::default_patterns(int num_blocks_x, int num_blocks_y) {
+    if (num_blocks_x == 4 && num_blocks_y == 4) {
+        // 6-6-3: top row, then the lower-left and lower-right 2x3 blocks
+        return { {1, 2, 3}, {4, 5, 8, 9, 12, 13}, {6, 7, 10, 11, 14, 15} };
+    }
+    if (num_blocks_x == 5 && num_blocks_y == 5) {
+        // 6-6-6-6
+        return { {1, 2, 5, 6, 10, 11}, {3, 4, 7, 8, 9, 13}, {12, 15, 16, 17, 20, 21}, {14, 18, 19, 22, 23, 24} };
+    }
+    return {};
+}
+
+bool PatternDB::generate(const std::string& path, int num_blocks_x, int num_blocks_y, const std::vector<std::vector<int>>& patterns) {
+    int n = num_blocks_x * num_blocks_y;
+    if (n > 64 || patterns.empty()) {
+        return false;
+    }
+
+    PatternDBHeader header{};
+    std::memcpy(header.magic, PATTERN_DB_MAGIC, 4);
+    header.version = PATTERN_DB_VERSION;
+    header.cols = static_cast<uint8_t>(num_blocks_x);
+    header.rows = static_cast<uint8_t>(num_blocks_y);
+    header.pattern_count = static_cast<uint32_t>(patterns.size());
+
+    std::vector<PatternDBPattern> table(patterns.size());
+    uint64_t offset = sizeof(PatternDBHeader) + table.size() * sizeof(PatternDBPattern);
+
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        int k = static_cast<int>(patterns[p].size());
+        if (k == 0 || k > PATTERN_DB_MAX_TILES || k >= n) {
+            return false;
+        }
+
+        table[p].tile_count = static_cast<uint8_t>(k);
+        for (int i = 0; i < k; ++i) {
+            table[p].tiles[i] = static_cast<uint8_t>(patterns[p][i]);
+        }
+
+        // Keep every table page aligned so lookups never straddle the header
+        offset = (offset + 4095) & ~uint64_t(4095);
+        table[p].offset = offset;
+        table[p].entries = falling_factorial(n, k);
+        offset += (table[p].entries + 1) / 2;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to open pattern database for writing: " << path << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(PatternDBPattern));
+
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        const auto& tiles = patterns[p];
+        int k = static_cast<int>(tiles.size());
+
+        std::cout << "Pattern " << p + 1 << "/" << patterns.size() << " (" << k << " tiles)..." << std::endl;
+        std::vector<uint8_t> dist = search_pattern(tiles, num_blocks_x, num_blocks_y);
+
+        // The (k + 1)-rank puts the blank in the last digit, so all blank cells of a pattern state are contiguous
+        uint64_t blanks = static_cast<uint64_t>(n - k);
+        std::vector<uint8_t> packed((table[p].entries + 1) / 2, 0);
+
+        Parallel::for_chunks(table[p].entries, BFS_CHUNK, [&](uint64_t begin, uint64_t end) {
+            std::array<int, PATTERN_DB_MAX_TILES> cells{};
+            for (uint64_t q = begin; q < end; ++q) {
+                int best = EXPANDED;
+                for (uint64_t b = 0; b < blanks; ++b) {
+                    best = std::min(best, dist[q * blanks + b] & ~EXPANDED);
+                }
+
+                unrank_cells(q, k, n, cells.data());
+                int md = 0;
+                for (int i = 0; i < k; ++i) {
+                    md += std::abs(cells[i] % num_blocks_x - tiles[i] % num_blocks_x) + std::abs(cells[i] / num_blocks_x - tiles[i] / num_blocks_x);
+                }
+
+                uint8_t nibble = static_cast<uint8_t>(std::min(15, (best - md) / 2));
+                std::atomic_ref<uint8_t>(packed[q >> 1]).fetch_or((q & 1) ? nibble << 4 : nibble, std::memory_order_relaxed);
+            }
+        });
+
+        std::vector<char> padding(static_cast<size_t>(table[p].offset - static_cast<uint64_t>(out.tellp())), 0);
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+
+    return static_cast<bool>(out);
+}
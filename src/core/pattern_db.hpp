@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+constexpr int PATTERN_DB_VERSION = 1;
+constexpr int PATTERN_DB_MAX_TILES = 14;
+
+// On-disk layout: header, pattern table, then one nibble-packed table per pattern.
+// Each nibble holds (pdb - md) / 2, where md is the Manhattan distance of the pattern's
+// tiles; the difference is always even, and clamping it to 15 keeps the bound admissible.
+struct PatternDBHeader {
+    char magic[4];
+    uint16_t version;
+    uint8_t cols, rows;
+    uint32_t pattern_count;
+    uint32_t reserved;
+};
+
+struct PatternDBPattern {
+    uint8_t tile_count;
+    uint8_t tiles[PATTERN_DB_MAX_TILES + 1];
+    uint64_t offset;    // byte offset of the nibble table from the start of the file
+    uint64_t entries;   // n! / (n - tile_count)! abstract states
+};
+
+// Disjoint additive pattern database for one board size, mapped read-only from disk
+class PatternDB {
+public:
+    bool open(const std::string& path);
+
+    int cols() const { return header->cols; }
+    int rows() const { return header->rows; }
+    int pattern_count() const { return static_cast<int>(header->pattern_count); }
+    int tile_pattern(int tile) const { return pattern_of[tile]; }
+
+    // Rank of the pattern tiles' cells; position is indexed by tile id
+    uint64_t index(int pattern, const int* position) const;
+
+    // Additional moves beyond the pattern's Manhattan distance, divided by two
+    int lookup(int pattern, uint64_t index) const {
+        uint8_t byte = tables[pattern][index >> 1];
+        return (index & 1) ? (byte >> 4) : (byte & 0x0F);
+    }
+
+    // Registry of databases loaded at startup, looked up by the solver
+    static void load_all(const std::string& dir);
+    static const PatternDB* find(int num_blocks_x, int num_blocks_y);
+
+    static std::string file_name(int num_blocks_x, int num_blocks_y);
+    static std::vector<std::vector<int>> default_patterns(int num_blocks_x, int num_blocks_y);
+
+    // Breadth-first search over the abstracted states of each pattern, writes the database to path
+    static bool generate(const std::string& path, int num_blocks_x, int num_blocks_y, const std::vector<std::vector<int>>& patterns);
+
+private:
+    MappedFile file;
+    const PatternDBHeader* header = nullptr;
+    const PatternDBPattern* patterns = nullptr;
+    std::vector<const uint8_t*> tables;
+    std::vector<int> pattern_of;
+};
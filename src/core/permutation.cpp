@@ -0,0 +1,94 @@
+#include "permutation.hpp"
+
+#include <bit>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace {
+
+constexpr uint64_t ZOBRIST_SEED = 0x5245564953494F4Eull;   // "REVISION"
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Past 20 elements the rank overflows 64 bits and unrank's digit buffer
+void check_size(int n) {
+    if (n < 0 || n > Permutation::MAX_RANK_SIZE) {
+        throw std::out_of_range("Permutation rank needs at most " + std::to_string(Permutation::MAX_RANK_SIZE) +
+                                " elements, got " + std::to_string(n));
+    }
+}
+
+} // namespace
+
+
+uint64_t Permutation::rank(const int* perm, int n) {
+    check_size(n);
+    uint32_t seen = 0;
+    uint64_t idx = 0;
+    for (int i = 0; i < n; ++i) {
+        uint32_t bit = 1u << perm[i];
+        int smaller = perm[i] - std::popcount(seen & (bit - 1));
+        idx = idx * static_cast<uint64_t>(n - i) + static_cast<uint64_t>(smaller);
+        seen |= bit;
+    }
+    return idx;
+}
+
+uint64_t Permutation::rank(const std::vector<int>& perm) {
+    return rank(perm.data(), static_cast<int>(perm.size()));
+}
+
+void Permutation::unrank(uint64_t idx, int n, int* perm) {
+    check_size(n);
+    int digits[MAX_RANK_SIZE];
+    for (int i = n - 1; i >= 0; --i) {
+        uint64_t radix = static_cast<uint64_t>(n - i);
+        digits[i] = static_cast<int>(idx % radix);
+        idx /= radix;
+    }
+
+    // The value of each position is the digit-th value not used yet, i.e. the digit-th set bit of `unused`
+    uint32_t unused = (1u << n) - 1;
+    for (int i = 0; i < n; ++i) {
+        uint32_t candidates = unused;
+        for (int r = digits[i]; r > 0; --r) {
+            candidates &= candidates - 1;
+        }
+        perm[i] = std::countr_zero(candidates);
+        unused &= ~(1u << perm[i]);
+    }
+}
+
+std::vector<int> Permutation::unrank(uint64_t idx, int n) {
+    std::vector<int> perm(n);
+    unrank(idx, n, perm.data());
+    return perm;
+}
+
+uint64_t Permutation::factorial(int n) {
+    uint64_t result = 1;
+    for (int i = 2; i <= n; ++i) {
+        result *= static_cast<uint64_t>(i);
+    }
+    return result;
+}
+
+uint64_t Zobrist::key(int tile, int cell) {
+    return mix(ZOBRIST_SEED + (static_cast<uint64_t>(tile) << 32 | static_cast<uint32_t>(cell)) * 0x9E3779B97F4A7C15ull);
+}
+
+uint64_t Zobrist::hash(const std::vector<int>& perm) {
+    uint64_t h = 0;
+    for (std::size_t cell = 0; cell < perm.size(); ++cell) {
+        h ^= key(perm[cell], static_cast<int>(cell));
+    }
+    return h;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Lehmer code rank of a permutation of 0..n-1, in lexicographic order. 20! still fits in
+// 64 bits, so every board up to 4x5 has a compact, canonical integer identity.
+class Permutation {
+public:
+    static constexpr int MAX_RANK_SIZE = 20;
+
+    // O(n): each Lehmer digit is the value minus the number of smaller values already seen, one popcount.
+    // rank and unrank throw std::out_of_range for more than MAX_RANK_SIZE elements.
+    static uint64_t rank(const int* perm, int n);
+    static uint64_t rank(const std::vector<int>& perm);
+
+    static void unrank(uint64_t idx, int n, int* perm);
+    static std::vector<int> unrank(uint64_t idx, int n);
+
+    static uint64_t factorial(int n);
+};
+
+// Zobrist hash of a board state: the xor of one fixed 64-bit key per (tile, cell) pair, blank included.
+// Keys are derived from a constant seed, so hashes are stable across runs and board sizes.
+class Zobrist {
+public:
+    static uint64_t key(int tile, int cell);
+    static uint64_t hash(const std::vector<int>& perm);
+
+    // Hash after the tile on cell `from` slides into the blank on cell `to`
+    static uint64_t slide(uint64_t hash, int tile, int from, int to) {
+        return hash ^ key(tile, from) ^ key(tile, to) ^ key(0, to) ^ key(0, from);
+    }
+};
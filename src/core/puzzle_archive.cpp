@@ -0,0 +1,197 @@
+#include "puzzle_archive.hpp"
+
+#include <map>
+#include <span>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <zlib.h>
+
+
+namespace {
+
+constexpr uint8_t UNCHECKED = 0;
+constexpr uint8_t VALID = 1;
+constexpr uint8_t CORRUPT = 2;
+
+} // namespace
+
+
+const PuzzleArchive* PuzzleArchive::find(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<PuzzleArchive>> archives;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = archives[path];
+    if (!slot) {
+        auto archive = std::make_unique<PuzzleArchive>();
+        if (!archive->open(path)) {
+            archives.erase(path);
+            return nullptr;
+        }
+        slot = std::move(archive);
+    }
+    return slot.get();
+}
+
+bool PuzzleArchive::open(const std::string& path) {
+    header = nullptr;
+    entries = nullptr;
+    checked.reset();
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // Anything without the magic is a legacy archive, addressed through puzzles.json alone
+    if (file.size() < sizeof(PuzzleArchiveHeader) || std::memcmp(file.data(), PUZZLE_ARCHIVE_MAGIC, 4) != 0) {
+        return true;
+    }
+
+    const auto* candidate = reinterpret_cast<const PuzzleArchiveHeader*>(file.data());
+    if (candidate->version != PUZZLE_ARCHIVE_VERSION) {
+        std::cerr << "Unsupported puzzle archive version " << candidate->version << ": " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    uint64_t records = static_cast<uint64_t>(candidate->entry_count) * (1 + static_cast<uint64_t>(candidate->mip_levels));
+    uint64_t index_end = candidate->index_offset + records * sizeof(PuzzleArchiveEntry);
+    if (candidate->index_offset % alignof(PuzzleArchiveEntry) != 0 || index_end > file.size()) {
+        std::cerr << "Corrupt puzzle archive index: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    header = candidate;
+    entries = reinterpret_cast<const PuzzleArchiveEntry*>(file.data() + header->index_offset);
+    checked = std::make_unique<std::atomic<uint8_t>[]>(records);
+    return true;
+}
+
+int PuzzleArchive::find_entry(uint64_t offset) const {
+    // The builder writes entries in file order
+    const PuzzleArchiveEntry* end = entries + entry_count();
+    const PuzzleArchiveEntry* it = std::lower_bound(entries, end, offset, [](const PuzzleArchiveEntry& e, uint64_t value) {
+        return e.offset < value;
+    });
+    return (it != end && it->offset == offset) ? static_cast<int>(it - entries) : -1;
+}
+
+int PuzzleArchive::mip_record(int index, int level) const {
+    if (index < 0 || index >= entry_count() || level < 0 || level >= mip_levels()) {
+        return -1;
+    }
+    return entry_count() + index * mip_levels() + level;
+}
+
+int PuzzleArchive::find_mip(int index, int width, int height) const {
+    if (index < 0 || index >= entry_count() || width <= 0 || height <= 0) {
+        return -1;
+    }
+
+    // Levels are stored aspect-fitted, so they are compared with the fitted size, not the box:
+    // a 16:9 image drawn into the 740x480 preview area needs 740x416, exactly level 0
+    int fit_width = 0, fit_height = 0;
+    fit_size(entries[index].width, entries[index].height, width, height, fit_width, fit_height);
+
+    // Levels shrink, so the last one that still covers the target is the cheapest to decode
+    int best = -1;
+    for (int level = 0; level < mip_levels(); ++level) {
+        const PuzzleArchiveEntry& e = entries[mip_record(index, level)];
+        if (e.width < fit_width || e.height < fit_height) {
+            break;
+        }
+        best = level;
+    }
+    return best;
+}
+
+void PuzzleArchive::fit_size(int width, int height, int max_width, int max_height, int& fit_width, int& fit_height) {
+    double aspect = static_cast<double>(width) / height;
+
+    if (aspect > 1.0) {
+        fit_width = max_width;
+        fit_height = static_cast<int>(fit_width / aspect);
+
+        if (fit_height > max_height) {
+            fit_height = max_height;
+            fit_width = static_cast<int>(fit_height * aspect);
+        }
+    }
+    else {
+        fit_height = max_height;
+        fit_width = static_cast<int>(fit_height * aspect);
+
+        if (fit_width > max_width) {
+            fit_width = max_width;
+            fit_height = static_cast<int>(fit_width / aspect);
+        }
+    }
+}
+
+std::span<const uint8_t> PuzzleArchive::view(uint64_t offset, uint64_t length) const {
+    if (offset > file.size() || length > file.size() - offset) {
+        return {};
+    }
+    return {file.data() + offset, static_cast<size_t>(length)};
+}
+
+bool PuzzleArchive::validate(int index) const {
+    if (index < 0 || index >= record_count()) {
+        return false;
+    }
+
+    uint8_t state = checked[index].load(std::memory_order_acquire);
+    if (state == UNCHECKED) {
+        const PuzzleArchiveEntry& e = entries[index];
+        std::span<const uint8_t> stored = view(e.offset, e.stored_size);
+        bool ok = !stored.empty() && crc32(0L, stored.data(), static_cast<uInt>(stored.size())) == e.crc32;
+
+        state = ok ? VALID : CORRUPT;
+        checked[index].store(state, std::memory_order_release);
+    }
+    return state == VALID;
+}
+
+std::span<const uint8_t> PuzzleArchive::extract(int index, std::vector<uint8_t>& buffer) const {
+    if (!validate(index)) {
+        return {};
+    }
+
+    const PuzzleArchiveEntry& e = entries[index];
+    if (!(e.codec & CODEC_ZLIB)) {
+        return view(e.offset, e.stored_size);
+    }
+
+    buffer.resize(e.uncompressed_size);
+    if (!extract_to(index, buffer)) {
+        return {};
+    }
+    return {buffer.data(), buffer.size()};
+}
+
+bool PuzzleArchive::extract_to(int index, std::span<uint8_t> out) const {
+    if (!validate(index) || out.size() != entries[index].uncompressed_size) {
+        return false;
+    }
+
+    const PuzzleArchiveEntry& e = entries[index];
+    std::span<const uint8_t> stored = view(e.offset, e.stored_size);
+    if (!(e.codec & CODEC_ZLIB)) {
+        if (stored.size() != out.size()) {
+            return false;
+        }
+        std::copy(stored.begin(), stored.end(), out.begin());
+        return true;
+    }
+
+    uLongf size = static_cast<uLongf>(out.size());
+    return uncompress(out.data(), &size, stored.data(), static_cast<uLong>(stored.size())) == Z_OK && size == out.size();
+}
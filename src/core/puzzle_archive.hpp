@@ -0,0 +1,113 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+constexpr char PUZZLE_ARCHIVE_MAGIC[4] = {'R', 'V', 'P', 'A'};
+constexpr uint32_t PUZZLE_ARCHIVE_VERSION = 2;
+
+// Encoding of the image bytes once the entry codec has been undone
+enum class ImageFormat : uint8_t {
+    UNKNOWN = 0,
+    JPEG = 1,
+    PNG = 2,
+    BGR = 3,        // width * height * 3 bytes of 8-bit BGR pixels, row-major without padding
+};
+
+// Entry codec flags; an entry without any is stored as is and read in place from the mapping
+constexpr uint8_t CODEC_ZLIB = 0x01;    // stored bytes are a zlib stream
+
+// Mip chain the builder stores per entry: level 0 fits the menu preview area the same way the
+// menu lays it out, and every further level halves it. Levels are plain JPEGs.
+constexpr int PREVIEW_MAX_WIDTH = 740;
+constexpr int PREVIEW_MAX_HEIGHT = 480;
+constexpr int PREVIEW_MIP_LEVELS = 3;
+
+// Version 2 layout: header, entry_count index records, entry_count * mip_levels mip records
+// (those of entry i at entry_count + i * mip_levels + level), then the data. All integers are
+// little-endian. Version 1 archives have no header; their entries are zlib-compressed JPEGs
+// located only by the offset/length pairs in puzzles.json.
+struct PuzzleArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t mip_levels;            // 0 in archives written without previews
+    uint64_t index_offset;          // byte offset of the first PuzzleArchiveEntry
+    uint64_t data_offset;           // byte offset of the first entry's data
+};
+
+struct PuzzleArchiveEntry {
+    uint64_t offset;                // byte offset of the stored data from the start of the file
+    uint64_t stored_size;
+    uint64_t uncompressed_size;     // size of the image bytes after undoing the codec
+    uint32_t crc32;                 // of the stored bytes
+    uint16_t width, height;         // image size in pixels
+    uint8_t format;                 // ImageFormat
+    uint8_t codec;                  // CODEC_* flags
+    uint8_t reserved[14];
+};
+
+static_assert(sizeof(PuzzleArchiveHeader) == 32 && sizeof(PuzzleArchiveEntry) == 48, "archive records must keep their on-disk size");
+
+// Read-only view of the puzzle image archive (res/puzzles.dat). The file is mapped once and
+// entries are handed out as spans into the mapping, so loading an image neither reopens the
+// file nor copies its bytes before they are decompressed.
+class PuzzleArchive {
+public:
+    // Maps the archive on first use and keeps it for the lifetime of the process; nullptr if it cannot be opened
+    static const PuzzleArchive* find(const std::string& path);
+
+    bool open(const std::string& path);
+
+    // 1 for a headerless legacy archive, which has no index
+    int version() const { return header ? static_cast<int>(header->version) : 1; }
+    int entry_count() const { return header ? static_cast<int>(header->entry_count) : 0; }
+    int mip_levels() const { return header ? static_cast<int>(header->mip_levels) : 0; }
+
+    // Entries and mip levels share one record table; the methods below take any record index
+    int record_count() const { return entry_count() * (1 + mip_levels()); }
+    const PuzzleArchiveEntry& entry(int index) const { return entries[index]; }
+
+    // Record of the entry's mip level, -1 if the archive has none
+    int mip_record(int index, int level) const;
+
+    // Smallest mip level of the entry covering the image fitted into a width x height box (as the
+    // menu draws it), -1 if only the full image does
+    int find_mip(int index, int width, int height) const;
+
+    // Size of a width x height image scaled to fill max_width x max_height without changing its aspect
+    static void fit_size(int width, int height, int max_width, int max_height, int& fit_width, int& fit_height);
+
+    // Index of the entry whose data starts at offset, -1 if there is none
+    int find_entry(uint64_t offset) const;
+
+    // Bytes [offset, offset + length) of the archive, empty if the range lies outside the file
+    std::span<const uint8_t> view(uint64_t offset, uint64_t length) const;
+
+    // Checks the entry's CRC32 the first time it is asked for and remembers the outcome
+    bool validate(int index) const;
+
+    // Image bytes of a validated entry: a view of the mapping itself when the entry is stored
+    // uncompressed, otherwise inflated into buffer in a single exact-size call. Empty on any error.
+    std::span<const uint8_t> extract(int index, std::vector<uint8_t>& buffer) const;
+
+    // Same into caller memory of exactly uncompressed_size bytes, e.g. the pixels of an image
+    bool extract_to(int index, std::span<uint8_t> out) const;
+
+    size_t size() const { return file.size(); }
+
+private:
+    MappedFile file;
+    const PuzzleArchiveHeader* header = nullptr;
+    const PuzzleArchiveEntry* entries = nullptr;
+
+    // Per entry: 0 not checked yet, 1 valid, 2 corrupt
+    std::unique_ptr<std::atomic<uint8_t>[]> checked;
+};
@@ -0,0 +1,176 @@
+#include "shuffler.hpp"
+
+#include "board.hpp"
+#include "bitboard.hpp"
+#include "solver.hpp"
+#include "distance_table.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+
+namespace {
+
+// Node budget for verifying one candidate of the length band on boards without a distance table
+constexpr uint64_t LENGTH_CHECK_MAX_NODES = 20'000'000;
+
+int blank_index(const std::vector<int>& perm) {
+    return static_cast<int>(std::find(perm.begin(), perm.end(), 0) - perm.begin());
+}
+
+// Non-backtracking random walk of `length` moves; the board stays packed in registers for the fixed sizes
+template<typename B>
+std::vector<int> random_walk(B board, int length, Shuffler& shuffler) {
+    int prev = -1;
+    for (int i = 0; i < length; ++i) {
+        int cells[4], candidates[4], count = 0;
+        int legal = board.legal_moves(cells);
+        for (int k = 0; k < legal; ++k) {
+            if (cells[k] != prev) {
+                candidates[count++] = cells[k];
+            }
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        prev = board.blank();
+        board.slide(candidates[shuffler.below(count)]);
+    }
+    return board.perm();
+}
+
+} // namespace
+
+
+Shuffler::Shuffler() : Shuffler(std::random_device{}() ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) {
+}
+
+Shuffler::Shuffler(uint64_t seed) : state(seed) {
+}
+
+// splitmix64
+uint64_t Shuffler::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform integer in [0, bound) by multiply-shift; the bias is negligible for board sizes
+int Shuffler::below(int bound) {
+    return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+}
+
+bool Shuffler::is_solvable(std::vector<int>& perm, int num_blocks_x) {
+    int n = static_cast<int>(perm.size());
+    int transpositions = 0, blank = 0;
+
+    // Walk the cycles, marking visited entries by flipping their sign so no scratch memory is needed
+    for (int i = 0; i < n; ++i) {
+        if (perm[i] == 0 || perm[i] == -1) {
+            blank = i;
+        }
+        if (perm[i] < 0) {
+            continue;
+        }
+
+        int length = 0;
+        for (int j = i; perm[j] >= 0; ) {
+            int next_j = perm[j];
+            perm[j] = -perm[j] - 1;
+            j = next_j;
+            ++length;
+        }
+        transpositions += length - 1;
+    }
+
+    for (int& v : perm) {
+        v = -v - 1;
+    }
+
+    int blank_distance = blank % num_blocks_x + blank / num_blocks_x;
+    return (transpositions & 1) == (blank_distance & 1);
+}
+
+int Shuffler::uniform(std::vector<int>& perm, int num_blocks_x, int num_blocks_y) {
+    int n = num_blocks_x * num_blocks_y;
+    perm.resize(n);
+    std::iota(perm.begin(), perm.end(), 0);
+
+    // Fisher-Yates
+    for (int i = n - 1; i > 0; --i) {
+        std::swap(perm[i], perm[below(i + 1)]);
+    }
+
+    // Swapping two non-blank tiles flips the parity without moving the blank; for a fixed blank
+    // position this pairs unsolvable and solvable permutations one to one, so the result stays uniform
+    if (n >= 3 && !is_solvable(perm, num_blocks_x)) {
+        int a = (perm[0] == 0) ? 1 : 0;
+        int b = (perm[a + 1] == 0) ? a + 2 : a + 1;
+        std::swap(perm[a], perm[b]);
+    }
+
+    return blank_index(perm);
+}
+
+int Shuffler::shuffle(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int min_challenge) {
+    int empty_idx = 0;
+    do {
+        empty_idx = uniform(perm, num_blocks_x, num_blocks_y);
+    }
+    while (Board::manhattan_distance(perm, num_blocks_x, num_blocks_y) < min_challenge);
+
+    return empty_idx;
+}
+
+int Shuffler::default_challenge(int num_blocks_x, int num_blocks_y) {
+    return std::max(6, 2 * (num_blocks_x * num_blocks_y - 1));
+}
+
+int Shuffler::with_length(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int min_moves, int max_moves, int max_attempts) {
+    int n = num_blocks_x * num_blocks_y;
+    if (min_moves > max_moves || max_moves < 0) {
+        return -1;
+    }
+
+    // Small boards: rejection sampling against the exact distance table keeps the draw uniform within the band
+    if (const DistanceTable* table = DistanceTable::find(num_blocks_x, num_blocks_y)) {
+        for (int attempt = 0; attempt < max_attempts; ++attempt) {
+            uniform(perm, num_blocks_x, num_blocks_y);
+            int d = table->distance(perm);
+            if (d >= min_moves && d <= max_moves) {
+                return blank_index(perm);
+            }
+        }
+        return -1;
+    }
+
+    // Larger boards: a non-backtracking walk of L moves has an optimal solution of at most L moves,
+    // so walk a length inside the band and verify the exact optimum with the solver
+    SolveOptions options;
+    options.max_nodes = LENGTH_CHECK_MAX_NODES;
+
+    for (int attempt = 0; attempt < max_attempts; ++attempt) {
+        perm.resize(n);
+        std::iota(perm.begin(), perm.end(), 0);
+
+        int walk = min_moves + below(max_moves - min_moves + 1);
+        perm = visit_board(perm, num_blocks_x, num_blocks_y, [&](auto board) {
+            return random_walk(std::move(board), walk, *this);
+        });
+
+        SolveResult result = Solver::solve(perm, num_blocks_x, num_blocks_y, options);
+        int length = static_cast<int>(result.moves.size());
+        if (result.solved && length >= min_moves && length <= max_moves) {
+            return blank_index(perm);
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Seedable generator of solvable puzzle permutations (tile `0` is the blank)
+class Shuffler {
+public:
+    Shuffler();
+    explicit Shuffler(uint64_t seed);
+
+    // Uniformly random solvable permutation of perm.size() == num_blocks_x * num_blocks_y tiles.
+    // Works in place without allocating; returns the blank's index.
+    int uniform(std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+
+    // Permutation whose optimal solution length lies in [min_moves, max_moves].
+    // Returns the blank's index, or -1 if no such permutation was found within max_attempts.
+    int with_length(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int min_moves, int max_moves, int max_attempts = 1000);
+
+    // Uniform draw with at least min_challenge Manhattan distance, as used by the game; returns the blank's index
+    int shuffle(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int min_challenge);
+    static int default_challenge(int num_blocks_x, int num_blocks_y);
+
+    uint64_t next();
+    int below(int bound);
+
+    // Permutation parity matches the parity of the blank's distance from the top-left
+    static bool is_solvable(std::vector<int>& perm, int num_blocks_x);
+
+private:
+    uint64_t state;
+};
@@ -0,0 +1,579 @@
+#include "solver.hpp"
+
+#include "bitboard.hpp"
+#include "parallel.hpp"
+#include "pattern_db.hpp"
+#include "distance_table.hpp"
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+
+
+namespace {
+
+constexpr int FOUND = -1;
+constexpr int CANCELLED = -2;
+constexpr uint64_t CANCEL_POLL_MASK = 0x3FFF;
+constexpr int INF = std::numeric_limits<int>::max();
+
+// The parallel search splits the tree at the first depth with at least this many nodes per thread
+constexpr int FRONTIER_ITEMS_PER_THREAD = 64;
+constexpr int MAX_FRONTIER_DEPTH = 24;
+
+// perm holds every cell index of a num_blocks_x x num_blocks_y board exactly once; the packed
+// boards index by it without bounds checks
+bool is_board(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) {
+    int n = num_blocks_x * num_blocks_y;
+    if (num_blocks_x < 1 || num_blocks_y < 1 || num_blocks_x > 64 || num_blocks_y > 64 || static_cast<int>(perm.size()) != n) {
+        return false;
+    }
+
+    std::vector<bool> seen(n, false);
+    for (int tile : perm) {
+        if (tile < 0 || tile >= n || seen[tile]) {
+            return false;
+        }
+        seen[tile] = true;
+    }
+    return true;
+}
+
+// State shared by the workers of one parallel IDA* iteration
+struct SharedSearch {
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<int> solved_item{INF};     // lowest frontier item with a solution so far
+    std::atomic<int> next_bound{INF};
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;
+    std::vector<int> solution;             // moves of solved_item's solution
+};
+
+// Frontier items owned by one worker: it pops its lowest index, thieves take the highest
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<int> items;
+};
+
+// B is a BitBoard for the common fixed sizes, where every table lookup and move folds to
+// constants and register operations, and the runtime-sized Board otherwise
+template<typename B>
+struct SearchContext {
+    B board;
+    uint64_t nodes = 0;
+    const std::atomic<bool>* cancel = nullptr;
+    uint64_t max_nodes = 0;
+
+    SharedSearch* shared = nullptr;              // set for the workers of a parallel search
+    int item = 0;                                // frontier item being searched
+    uint64_t reported_nodes = 0;                 // part of `nodes` already added to shared->nodes
+
+    std::vector<int> distance;                   // distance[tile * n + cell] for the runtime-sized board
+    std::vector<CellNeighbors> neighbors;        // same
+    std::vector<int> row_conflicts, col_conflicts;
+    int conflicts = 0;                           // sum over all lines
+
+    const PatternDB* pdb = nullptr;              // optional additive pattern database
+    std::vector<int> position;                   // cell of each tile
+    std::vector<int> pattern_values;
+    int pattern_sum = 0;
+
+    std::vector<int> path;
+};
+
+template<typename B>
+int distance(const SearchContext<B>& ctx, int tile, int cell) {
+    if constexpr (IS_BIT_BOARD<B>) {
+        return B::DISTANCE[tile * B::SIZE + cell];
+    }
+    else {
+        return ctx.distance[tile * ctx.board.size() + cell];
+    }
+}
+
+template<typename B>
+const CellNeighbors& neighbors(const SearchContext<B>& ctx, int cell) {
+    if constexpr (IS_BIT_BOARD<B>) {
+        return B::NEIGHBORS[cell];
+    }
+    else {
+        return ctx.neighbors[cell];
+    }
+}
+
+// Minimum number of tiles to remove from a line so that the rest are in goal order (n - LIS)
+template<typename B>
+int line_conflicts(const SearchContext<B>& ctx, int line, bool is_row) {
+    std::array<int, 64> tail;   // entries below lis are always written before they are read
+    int cols = ctx.board.cols();
+    int count = 0, lis = 0;
+    int length = is_row ? cols : ctx.board.rows();
+
+    for (int i = 0; i < length; ++i) {
+        int cell = is_row ? line * cols + i : i * cols + line;
+        int tile = ctx.board.tile(cell);
+        if (tile == 0) {
+            continue;
+        }
+
+        int goal_line = is_row ? tile / cols : tile % cols;
+        if (goal_line != line) {
+            continue;
+        }
+
+        int goal_pos = is_row ? tile % cols : tile / cols;
+        auto it = std::lower_bound(tail.begin(), tail.begin() + lis, goal_pos);
+        *it = goal_pos;
+        if (it == tail.begin() + lis) {
+            ++lis;
+        }
+        ++count;
+    }
+
+    return count - lis;
+}
+
+template<typename B>
+void update_line(SearchContext<B>& ctx, int line, bool is_row) {
+    int& slot = is_row ? ctx.row_conflicts[line] : ctx.col_conflicts[line];
+    int value = line_conflicts(ctx, line, is_row);
+    ctx.conflicts += value - slot;
+    slot = value;
+}
+
+template<typename B>
+void update_pattern(SearchContext<B>& ctx, int pattern) {
+    int value = ctx.pdb->lookup(pattern, ctx.pdb->index(pattern, ctx.position.data()));
+    ctx.pattern_sum += value - ctx.pattern_values[pattern];
+    ctx.pattern_values[pattern] = value;
+}
+
+// Both bounds count the Manhattan distance plus twice some extra moves, so their maximum stays admissible
+template<typename B>
+int extra_moves(const SearchContext<B>& ctx) {
+    return 2 * std::max(ctx.conflicts, ctx.pattern_sum);
+}
+
+template<typename B>
+SearchContext<B> make_context(B board) {
+    SearchContext<B> ctx;
+    ctx.board = std::move(board);
+    int cols = ctx.board.cols(), rows = ctx.board.rows(), n = ctx.board.size();
+
+    if constexpr (!IS_BIT_BOARD<B>) {
+        ctx.distance.resize(n * n);
+        for (int tile = 0; tile < n; ++tile) {
+            for (int cell = 0; cell < n; ++cell) {
+                ctx.distance[tile * n + cell] = (tile == 0) ? 0 :
+                    std::abs(tile % cols - cell % cols) + std::abs(tile / cols - cell / cols);
+            }
+        }
+        ctx.neighbors = Board::neighbor_table(cols, rows);
+    }
+
+    ctx.row_conflicts.assign(rows, 0);
+    ctx.col_conflicts.assign(cols, 0);
+    for (int r = 0; r < rows; ++r) update_line(ctx, r, true);
+    for (int c = 0; c < cols; ++c) update_line(ctx, c, false);
+
+    ctx.position.resize(n);
+    for (int cell = 0; cell < n; ++cell) {
+        ctx.position[ctx.board.tile(cell)] = cell;
+    }
+
+    ctx.pdb = PatternDB::find(cols, rows);
+    if (ctx.pdb) {
+        ctx.pattern_values.assign(ctx.pdb->pattern_count(), 0);
+        for (int p = 0; p < ctx.pdb->pattern_count(); ++p) {
+            update_pattern(ctx, p);
+        }
+    }
+
+    return ctx;
+}
+
+template<typename B>
+int manhattan(const SearchContext<B>& ctx) {
+    int sum = 0;
+    for (int cell = 0; cell < ctx.board.size(); ++cell) {
+        sum += distance(ctx, ctx.board.tile(cell), cell);
+    }
+    return sum;
+}
+
+// Slides the tile at `cell` into the blank and updates the affected line conflicts.
+// Returns the new Manhattan sum.
+template<typename B>
+int apply_move(SearchContext<B>& ctx, int cell, int md) {
+    int cols = ctx.board.cols();
+    int from = ctx.board.blank();
+    int tile = ctx.board.tile(cell);
+    md += distance(ctx, tile, from) - distance(ctx, tile, cell);
+
+    ctx.board.slide(cell);
+    ctx.position[tile] = from;
+    ctx.position[0] = cell;
+
+    if (ctx.pdb && ctx.pdb->tile_pattern(tile) >= 0) {
+        update_pattern(ctx, ctx.pdb->tile_pattern(tile));
+    }
+
+    // A horizontal move only changes the order of the two columns involved, a vertical one of the two rows
+    if (cell / cols == from / cols) {
+        int goal_col = tile % cols;
+        if (goal_col == cell % cols || goal_col == from % cols) {
+            update_line(ctx, goal_col, false);
+        }
+    }
+    else {
+        int goal_row = tile / cols;
+        if (goal_row == cell / cols || goal_row == from / cols) {
+            update_line(ctx, goal_row, true);
+        }
+    }
+
+    return md;
+}
+
+template<typename B>
+void report_nodes(SearchContext<B>& ctx) {
+    ctx.shared->nodes.fetch_add(ctx.nodes - ctx.reported_nodes, std::memory_order_relaxed);
+    ctx.reported_nodes = ctx.nodes;
+}
+
+// Polled every few thousand nodes. A parallel worker also stops once an earlier frontier item has a solution.
+template<typename B>
+bool should_stop(SearchContext<B>& ctx) {
+    if (ctx.cancel && ctx.cancel->load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    uint64_t nodes = ctx.nodes;
+    if (ctx.shared) {
+        report_nodes(ctx);
+        nodes = ctx.shared->nodes.load(std::memory_order_relaxed);
+        if (ctx.shared->cancelled.load(std::memory_order_relaxed) || ctx.shared->solved_item.load(std::memory_order_relaxed) < ctx.item) {
+            return true;
+        }
+    }
+
+    return ctx.max_nodes && nodes >= ctx.max_nodes;
+}
+
+template<typename B>
+int search(SearchContext<B>& ctx, int g, int bound, int md, int prev_blank) {
+    if ((++ctx.nodes & CANCEL_POLL_MASK) == 0 && should_stop(ctx)) {
+        return CANCELLED;
+    }
+
+    int h = md + extra_moves(ctx);
+    int f = g + h;
+    if (f > bound) {
+        return f;
+    }
+
+    if (h == 0) {
+        return FOUND;
+    }
+
+    int min_next = INF;
+    int blank = ctx.board.blank();
+    const CellNeighbors& nb = neighbors(ctx, blank);
+
+    for (int i = 0; i < nb.count; ++i) {
+        int cell = nb.cells[i];
+
+        // Never undo the previous move
+        if (cell == prev_blank) {
+            continue;
+        }
+
+        int next_md = apply_move(ctx, cell, md);
+        ctx.path.push_back(cell);
+
+        int t = search(ctx, g + 1, bound, next_md, blank);
+        if (t == FOUND || t == CANCELLED) {
+            return t;
+        }
+
+        ctx.path.pop_back();
+        apply_move(ctx, blank, next_md);
+        min_next = std::min(min_next, t);
+    }
+
+    return min_next;
+}
+
+// Depth-first walk to `depth` collecting the path of every node within the bound, in the order
+// the sequential search would visit them. Goal nodes above that depth become items of their own.
+// Returns the smallest f of the pruned nodes.
+template<typename B>
+int collect_frontier(SearchContext<B>& ctx, int g, int depth, int bound, int md, int prev_blank, std::vector<std::vector<int>>& frontier) {
+    ++ctx.nodes;
+    int h = md + extra_moves(ctx);
+    int f = g + h;
+    if (f > bound) {
+        return f;
+    }
+
+    if (g == depth || h == 0) {
+        frontier.push_back(ctx.path);
+        return INF;
+    }
+
+    int min_next = INF;
+    int blank = ctx.board.blank();
+    const CellNeighbors& nb = neighbors(ctx, blank);
+
+    for (int i = 0; i < nb.count; ++i) {
+        int cell = nb.cells[i];
+        if (cell == prev_blank) {
+            continue;
+        }
+
+        int next_md = apply_move(ctx, cell, md);
+        ctx.path.push_back(cell);
+        min_next = std::min(min_next, collect_frontier(ctx, g + 1, depth, bound, next_md, blank, frontier));
+        ctx.path.pop_back();
+        apply_move(ctx, blank, next_md);
+    }
+
+    return min_next;
+}
+
+template<typename B>
+void search_items(const SearchContext<B>& root, int bound, int md, const std::vector<std::vector<int>>& frontier,
+                  std::vector<WorkQueue>& queues, int self, SharedSearch& shared) {
+    SearchContext<B> ctx;
+    int threads = static_cast<int>(queues.size());
+
+    while (true) {
+        int item = -1;
+        {
+            std::lock_guard<std::mutex> lock(queues[self].mutex);
+            if (!queues[self].items.empty()) {
+                item = queues[self].items.front();
+                queues[self].items.pop_front();
+            }
+        }
+
+        // Out of work: steal the last item of another worker
+        for (int k = 1; item < 0 && k < threads; ++k) {
+            WorkQueue& victim = queues[(self + k) % threads];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                item = victim.items.back();
+                victim.items.pop_back();
+            }
+        }
+
+        if (item < 0 || shared.cancelled.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        // Items after an already solved one cannot change the result
+        if (shared.solved_item.load(std::memory_order_relaxed) < item) {
+            continue;
+        }
+
+        // Copy-assignment keeps the vectors' storage, so replaying an item does not allocate
+        uint64_t nodes = ctx.nodes;
+        ctx = root;
+        ctx.nodes = ctx.reported_nodes = nodes;
+        ctx.shared = &shared;
+        ctx.item = item;
+
+        int item_md = md, prev_blank = -1;
+        for (int cell : frontier[item]) {
+            prev_blank = ctx.board.blank();
+            item_md = apply_move(ctx, cell, item_md);
+            ctx.path.push_back(cell);
+        }
+
+        int t = search(ctx, static_cast<int>(frontier[item].size()), bound, item_md, prev_blank);
+        if (t == FOUND) {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (item < shared.solved_item.load(std::memory_order_relaxed)) {
+                shared.solution = ctx.path;
+                shared.solved_item.store(item, std::memory_order_relaxed);
+            }
+        }
+        else if (t == CANCELLED) {
+            if (shared.solved_item.load(std::memory_order_relaxed) >= item) {
+                shared.cancelled.store(true, std::memory_order_relaxed);
+            }
+        }
+        else {
+            int current = shared.next_bound.load(std::memory_order_relaxed);
+            while (t < current && !shared.next_bound.compare_exchange_weak(current, t, std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    if (ctx.shared) {
+        report_nodes(ctx);
+    }
+}
+
+// One IDA* iteration on several threads: the tree is cut at a fixed depth and the subtrees below it
+// are searched by a work-stealing pool. All items before the first solved one are always searched to
+// completion, so the solution returned is the one the sequential search would find.
+template<typename B>
+int search_parallel(SearchContext<B>& ctx, int bound, int md, int threads) {
+    std::vector<std::vector<int>> frontier;
+    int min_next = INF;
+    for (int depth = 1; depth <= MAX_FRONTIER_DEPTH; ++depth) {
+        frontier.clear();
+        min_next = collect_frontier(ctx, 0, depth, bound, md, -1, frontier);
+        if (static_cast<int>(frontier.size()) >= threads * FRONTIER_ITEMS_PER_THREAD) {
+            break;
+        }
+    }
+
+    if (frontier.empty()) {
+        return min_next;
+    }
+
+    SharedSearch shared;
+    shared.nodes = ctx.nodes;
+    shared.next_bound = min_next;
+
+    // Interleaved so that every worker starts with the earliest items, where the first solution is most likely
+    std::vector<WorkQueue> queues(threads);
+    for (int i = 0; i < static_cast<int>(frontier.size()); ++i) {
+        queues[i % threads].items.push_back(i);
+    }
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            search_items(ctx, bound, md, frontier, queues, i, shared);
+        });
+    }
+
+    search_items(ctx, bound, md, frontier, queues, 0, shared);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ctx.nodes = shared.nodes.load();
+    if (shared.solved_item.load() != INF) {
+        ctx.path = std::move(shared.solution);
+        return FOUND;
+    }
+    if (shared.cancelled.load()) {
+        return CANCELLED;
+    }
+    return shared.next_bound.load();
+}
+
+template<typename B>
+SolveResult solve_board(B board, const SolveOptions& options) {
+    SolveResult result;
+    SearchContext<B> ctx = make_context(std::move(board));
+    ctx.cancel = options.cancel;
+    ctx.max_nodes = options.max_nodes;
+    int md = manhattan(ctx);
+    int bound = md + extra_moves(ctx);
+    int threads = (options.threads > 0) ? options.threads : static_cast<int>(Parallel::thread_count());
+
+    // Solution lengths always share the parity of the heuristic, so an external bound is rounded up to it
+    if (options.min_bound > bound) {
+        bound += (options.min_bound - bound + 1) & ~1;
+    }
+
+    while (true) {
+        result.lower_bound = bound;
+        int t = (threads > 1) ? search_parallel(ctx, bound, md, threads) : search(ctx, 0, bound, md, -1);
+
+        if (t == FOUND) {
+            result.moves = std::move(ctx.path);
+            result.solved = true;
+            break;
+        }
+
+        if (t == CANCELLED) {
+            result.cancelled = true;
+            break;
+        }
+
+        if (t == INF) {
+            break;
+        }
+        bound = t;
+    }
+
+    result.nodes = ctx.nodes;
+    return result;
+}
+
+} // namespace
+
+
+SolveResult Solver::solve(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y, const SolveOptions& options) {
+    SolveResult result;
+    if (!is_solvable(perm, num_blocks_x, num_blocks_y)) {
+        return result;
+    }
+
+    // Small boards are answered straight from the exact distance table
+    if (const DistanceTable* table = DistanceTable::find(num_blocks_x, num_blocks_y)) {
+        result.moves = table->solve(perm);
+        result.nodes = result.moves.size();
+        result.lower_bound = static_cast<int>(result.moves.size());
+        result.solved = true;
+        return result;
+    }
+
+    return visit_board(perm, num_blocks_x, num_blocks_y, [&](auto board) {
+        return solve_board(std::move(board), options);
+    });
+}
+
+int Solver::heuristic(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) {
+    if (!is_board(perm, num_blocks_x, num_blocks_y)) {
+        return -1;
+    }
+    return visit_board(perm, num_blocks_x, num_blocks_y, [](auto board) {
+        auto ctx = make_context(std::move(board));
+        return manhattan(ctx) + extra_moves(ctx);
+    });
+}
+
+bool Solver::is_solvable(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) {
+    if (!is_board(perm, num_blocks_x, num_blocks_y)) {
+        return false;
+    }
+
+    // Parity of the permutation (counted via its cycles) must match the blank's distance from the top-left
+    int n = num_blocks_x * num_blocks_y;
+    std::vector<bool> seen(n, false);
+    int transpositions = 0, blank = -1;
+
+    for (int i = 0; i < n; ++i) {
+        if (perm[i] == 0) {
+            blank = i;
+        }
+        if (seen[i]) {
+            continue;
+        }
+
+        int length = 0;
+        for (int j = i; !seen[j]; j = perm[j]) {
+            seen[j] = true;
+            ++length;
+        }
+        transpositions += length - 1;
+    }
+
+    int blank_distance = blank % num_blocks_x + blank / num_blocks_x;
+    return blank >= 0 && (transpositions % 2) == (blank_distance % 2);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// Result of an optimal search: moves lists, in order, the board index of the
+// tile that slides into the blank (i.e. the blank's next position).
+struct SolveResult {
+    std::vector<int> moves;
+    uint64_t nodes = 0;
+    bool solved = false;
+    bool cancelled = false;
+    int lower_bound = 0;    // proven lower bound on the solution length, exact when solved
+};
+
+struct SolveOptions {
+    int min_bound = 0;                           // known lower bound, skips the cheaper IDA* iterations
+    const std::atomic<bool>* cancel = nullptr;   // polled during the search
+    uint64_t max_nodes = 0;                      // gives up (as cancelled) after this many nodes, 0 for no limit
+    int threads = 1;                             // worker threads for the search, 0 for every core
+};
+
+class Solver {
+public:
+    // Optimal IDA* search towards the identity permutation (blank `0` at the top-left)
+    static SolveResult solve(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y, const SolveOptions& options = {});
+
+    // Manhattan distance plus linear conflicts (or pattern database moves when loaded), an admissible lower bound on the solution length;
+    // -1 if perm is not a permutation of the board's cells
+    static int heuristic(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+    static bool is_solvable(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
+};
@@ -0,0 +1,88 @@
+#include "startup_trace.hpp"
+
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+
+
+namespace {
+
+struct Timeline {
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, double>> stages;
+    bool printed = false;
+};
+
+Timeline& timeline() {
+    static Timeline instance;
+    return instance;
+}
+
+} // namespace
+
+
+void StartupTrace::begin() {
+    Timeline& t = timeline();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.start = std::chrono::steady_clock::now();
+    t.stages.clear();
+    t.printed = false;
+}
+
+void StartupTrace::mark(const std::string& stage) {
+    auto now = std::chrono::steady_clock::now();
+    Timeline& t = timeline();
+    std::lock_guard<std::mutex> lock(t.mutex);
+
+    auto seen = std::find_if(t.stages.begin(), t.stages.end(), [&](const auto& s) { return s.first == stage; });
+    if (seen == t.stages.end()) {
+        t.stages.emplace_back(stage, std::chrono::duration<double, std::milli>(now - t.start).count());
+    }
+}
+
+double StartupTrace::elapsed_ms(const std::string& stage) {
+    Timeline& t = timeline();
+    std::lock_guard<std::mutex> lock(t.mutex);
+
+    auto seen = std::find_if(t.stages.begin(), t.stages.end(), [&](const auto& s) { return s.first == stage; });
+    return (seen != t.stages.end()) ? seen->second : -1.0;
+}
+
+std::vector<std::pair<std::string, double>> StartupTrace::stages() {
+    Timeline& t = timeline();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.stages;
+}
+
+void StartupTrace::print(std::ostream& out) {
+    auto list = stages();
+    std::sort(list.begin(), list.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    char line[128];
+    for (const auto& [stage, ms] : list) {
+        std::snprintf(line, sizeof(line), "%9.2f ms  %s\n", ms, stage.c_str());
+        out << line;
+    }
+}
+
+void StartupTrace::print_if_enabled() {
+    {
+        Timeline& t = timeline();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if (t.printed || !std::getenv("REVISION_STARTUP_TRACE")) {
+            return;
+        }
+        t.printed = true;
+    }
+
+    std::cerr << "Startup trace:" << std::endl;
+    print(std::cerr);
+}
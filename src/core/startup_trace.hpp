@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+
+// Process-wide timeline of startup milestones, in milliseconds since begin(). Each stage is
+// recorded the first time it is reached, from any thread, so later redraws do not move it.
+class StartupTrace {
+public:
+    static void begin();
+    static void mark(const std::string& stage);
+
+    // Milliseconds from begin() to the stage, -1 if it has not been reached
+    static double elapsed_ms(const std::string& stage);
+    static std::vector<std::pair<std::string, double>> stages();
+
+    static void print(std::ostream& out);
+
+    // Prints the timeline once if the REVISION_STARTUP_TRACE environment variable is set
+    static void print_if_enabled();
+};
@@ -0,0 +1,78 @@
+#include "event_loop.hpp"
+
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+
+EventLoop::EventLoop(const std::string& winname) : winname(winname) {
+    cv::namedWindow(winname, cv::WINDOW_AUTOSIZE);
+    cv::setMouseCallback(winname, &EventLoop::on_mouse, this);
+}
+
+EventLoop::~EventLoop() {
+    // The screen may already have destroyed its window
+    if (window_open()) {
+        cv::setMouseCallback(winname, nullptr, nullptr);
+    }
+}
+
+void EventLoop::on_mouse(int event, int x, int y, int flags, void* userdata) {
+    // Runs inside waitKey on the loop's own thread, so the queue needs no lock
+    static_cast<EventLoop*>(userdata)->events.push_back(UiEvent{UiEvent::MOUSE, event, x, y, flags});
+}
+
+bool EventLoop::window_open() const {
+    return cv::getWindowProperty(winname, cv::WND_PROP_VISIBLE) >= 1;
+}
+
+bool EventLoop::next(UiEvent& event, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
+
+    while (true) {
+        if (!events.empty()) {
+            event = events.front();
+            events.pop_front();
+            return true;
+        }
+
+        if (!window_open()) {
+            event = UiEvent{UiEvent::CLOSED};
+            return true;
+        }
+
+        int wait_ms = FRAME_MS;
+        if (timeout_ms != FOREVER) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                return false;
+            }
+            wait_ms = static_cast<int>(std::min<long long>(wait_ms, remaining));
+        }
+
+        // Mouse events raised during the wait are queued ahead of the key that ended it
+        int key = cv::waitKey(wait_ms);
+        if (key >= 0) {
+            events.push_back(UiEvent{UiEvent::KEY, key});
+        }
+    }
+}
+
+bool EventLoop::pending() const {
+    return !events.empty();
+}
+
+void EventLoop::invalidate() {
+    needs_redraw = true;
+}
+
+bool EventLoop::dirty() const {
+    return needs_redraw;
+}
+
+void EventLoop::present(const cv::Mat& frame) {
+    cv::imshow(winname, frame);
+    needs_redraw = false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+struct UiEvent {
+    enum Type { MOUSE, KEY, CLOSED };
+
+    Type type = MOUSE;
+    int code = 0;                   // cv::EVENT_* for mouse events, the key code for keys
+    int x = 0, y = 0, flags = 0;
+};
+
+// Event loop of one HighGUI window. The mouse callback only queues events; next() hands them
+// out in order and otherwise sleeps inside waitKey, one frame at a time, since HighGUI only
+// delivers mouse input while waitKey runs. Screens mark their frame dirty and present it
+// once the queue is drained, so an idle window costs about 60 short wakeups a second.
+class EventLoop {
+public:
+    static constexpr int FRAME_MS = 16;
+    static constexpr int FOREVER = -1;
+
+    explicit EventLoop(const std::string& winname);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Next event, waiting up to timeout_ms for one; false on timeout. Reports CLOSED once the window is gone.
+    bool next(UiEvent& event, int timeout_ms = FOREVER);
+
+    // More events are already queued, so a redraw can wait for them
+    bool pending() const;
+
+    void invalidate();
+    bool dirty() const;
+
+    // Shows the frame and clears the dirty flag
+    void present(const cv::Mat& frame);
+
+private:
+    static void on_mouse(int event, int x, int y, int flags, void* userdata);
+    bool window_open() const;
+
+private:
+    std::string winname;
+    std::deque<UiEvent> events;
+    bool needs_redraw = false;
+};
@@ -0,0 +1,65 @@
+#include "font_manager.hpp"
+
+#include "core/startup_trace.hpp"
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <utility>
+#include <iostream>
+
+
+FontManager& FontManager::instance() {
+    static FontManager manager;
+    return manager;
+}
+
+FontManager::FontManager() {
+    if (FT_Init_FreeType(&ftlib)) {
+        std::cerr << "Failed to initialize FreeType" << std::endl;
+        ftlib = nullptr;
+    }
+}
+
+FontManager::~FontManager() {
+    // Sizes belong to their faces, so renderers go first
+    renderers.clear();
+    for (auto& [path, face] : faces) {
+        if (face) {
+            FT_Done_Face(face);
+        }
+    }
+
+    if (ftlib) {
+        FT_Done_FreeType(ftlib);
+    }
+}
+
+FT2TextRenderer& FontManager::renderer(const std::string& font_path, int font_height) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_pair(font_path, font_height);
+    auto it = renderers.find(key);
+    if (it != renderers.end()) {
+        return *it->second;
+    }
+
+    auto created = std::make_unique<FT2TextRenderer>(face(font_path), font_height);
+    return *renderers.emplace(key, std::move(created)).first->second;
+}
+
+FT_Face FontManager::face(const std::string& font_path) {
+    auto it = faces.find(font_path);
+    if (it != faces.end()) {
+        return it->second;
+    }
+
+    FT_Face face = nullptr;
+    if (!ftlib || FT_New_Face(ftlib, font_path.c_str(), 0, &face)) {
+        std::cerr << "Failed to load font: " << font_path << std::endl;
+        face = nullptr;
+    }
+    faces[font_path] = face;
+    StartupTrace::mark("font loaded");
+    return face;
+}
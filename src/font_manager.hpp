@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ft2.hpp"
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// Process-wide owner of the FreeType library, the opened font faces and one renderer per
+// (font, pixel height). Every screen draws through these shared renderers, so a face is
+// parsed once per process and the glyphs rasterized for one overlay serve all later ones.
+// Renderers are not thread-safe; text is drawn from the UI thread only.
+class FontManager {
+public:
+    static FontManager& instance();
+
+    FontManager(const FontManager&) = delete;
+    FontManager& operator=(const FontManager&) = delete;
+
+    // Opens the face on first use; a face that fails to load draws nothing
+    FT2TextRenderer& renderer(const std::string& font_path, int font_height);
+
+private:
+    FontManager();
+    ~FontManager();
+
+    FT_Face face(const std::string& font_path);
+
+private:
+    std::mutex mutex;
+    FT_Library ftlib = nullptr;
+    std::map<std::string, FT_Face> faces;
+    std::map<std::pair<std::string, int>, std::unique_ptr<FT2TextRenderer>> renderers;
+};
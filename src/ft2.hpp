@@ -1,12 +1,18 @@
 #pragma once
 
+#include "core/blend.hpp"
+
 #include <string>
 #include <vector>
 #include <locale>
+#include <cstdint>
+#include <cstring>
 #include <codecvt>
+#include <unordered_map>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include <opencv2/opencv.hpp>
 
 // Minimal UTF-8 to Unicode codepoint decoder
@@ -42,74 +48,137 @@ inline std::vector<uint32_t> utf8_to_codepoints(const std::string& utf8) {
     return codepoints;
 }
 
+// Draws text from a face owned by FontManager at one pixel height. Each renderer has its own
+// FT_Size on the shared face, so several heights coexist without reloading or resizing the face.
 class FT2TextRenderer {
 public:
-    FT2TextRenderer(const std::string& font_path, int font_height = 32) : font_height(font_height) {
-        FT_Init_FreeType(&ftlib);
-        FT_New_Face(ftlib, font_path.c_str(), 0, &face);
-        FT_Set_Pixel_Sizes(face, 0, font_height);
+    FT2TextRenderer(FT_Face face, int font_height = 32) : face(face), font_height(font_height) {
+        if (face && !FT_New_Size(face, &size)) {
+            FT_Activate_Size(size);
+            FT_Set_Pixel_Sizes(face, 0, font_height);
+        }
     }
 
     ~FT2TextRenderer() {
-        if (face) {
-            FT_Done_Face(face);
-        }
-
-        if (ftlib) {
-            FT_Done_FreeType(ftlib);
+        if (size) {
+            FT_Done_Size(size);
         }
     }
 
-    // Draws UTF-8 text at baseline (org.x, org.y) in BGR color
+    FT2TextRenderer(const FT2TextRenderer&) = delete;
+    FT2TextRenderer& operator=(const FT2TextRenderer&) = delete;
+
+    // Draws UTF-8 text at baseline (org.x, org.y) in BGR color on an 8-bit image of 1 to 4 channels
     void draw_text(cv::Mat& img, const std::string& text, cv::Point org, cv::Scalar color, int thickness = 1, bool center = false) {
-        auto codepoints = utf8_to_codepoints(text);
-        int baseline = org.y;
-        int x = org.x;
+        if (img.depth() != CV_8U || img.channels() > 4) {
+            return;
+        }
 
-        // Optionally measure width for centering
-        if (center) {
-            int width = 0;
-            FT_GlyphSlot slot = face->glyph;
+        const TextRun& run = layout(text);
+        int baseline = org.y;
+        int x = center ? org.x - run.width / 2 : org.x;
 
-            for (auto cp : codepoints) {
-                if (FT_Load_Char(face, cp, FT_LOAD_RENDER)) {
-                    continue;
-                }
-                width += (slot->advance.x >> 6);
-            }
-            x -= width / 2;
+        int channels = img.channels();
+        uint8_t pen[4];
+        for (int c = 0; c < 3; ++c) {
+            pen[c] = cv::saturate_cast<uint8_t>(color[c]);
         }
+        pen[3] = 255;       // cv::Scalar colors leave alpha at 0; text on 4-channel images stays opaque
+
+        for (size_t i = 0; i < run.glyphs.size(); ++i) {
+            const Glyph& glyph = *run.glyphs[i];
+            int gx = x + run.pen_x[i] + glyph.left;
+            int gy = baseline - glyph.top;
 
-        for (auto cp : codepoints) {
-            if (FT_Load_Char(face, cp, FT_LOAD_RENDER)) {
+            // Clip the glyph rectangle to the image once, then blend whole rows
+            cv::Rect clipped = cv::Rect(gx, gy, glyph.bitmap.cols, glyph.bitmap.rows) & cv::Rect(0, 0, img.cols, img.rows);
+            if (clipped.empty()) {
                 continue;
             }
 
+            Blend::coverage(img.ptr<uint8_t>(clipped.y, clipped.x), img.step, channels,
+                            glyph.bitmap.ptr<uint8_t>(clipped.y - gy, clipped.x - gx), glyph.bitmap.step,
+                            clipped.width, clipped.height, pen);
+        }
+    }
+
+    int pixel_height() const {
+        return font_height;
+    }
+
+    // Advance width of the text in pixels, as used for centering
+    int text_width(const std::string& text) {
+        return layout(text).width;
+    }
+
+private:
+    // Rasterized glyph: coverage bitmap plus the metrics needed to place it
+    struct Glyph {
+        cv::Mat bitmap;             // CV_8UC1 coverage, empty for blank or missing glyphs
+        int left = 0, top = 0;      // bitmap offset from the pen position and the baseline
+        int advance = 0;
+    };
+
+    // Laid-out string: the glyph of every codepoint and its pen offset from the start
+    struct TextRun {
+        std::vector<const Glyph*> glyphs;
+        std::vector<int> pen_x;
+        int width = 0;
+    };
+
+    // Menus draw a handful of distinct strings; the cap only guards against unbounded growth
+    static constexpr size_t MAX_CACHED_RUNS = 512;
+
+    // Each (codepoint, pixel size) is rendered by FreeType once; the map never moves its nodes
+    const Glyph& glyph(uint32_t cp) {
+        uint64_t key = (static_cast<uint64_t>(font_height) << 32) | cp;
+        auto it = glyphs.find(key);
+        if (it != glyphs.end()) {
+            return it->second;
+        }
+
+        Glyph& g = glyphs[key];
+        if (size && !FT_Activate_Size(size) && !FT_Load_Char(face, cp, FT_LOAD_RENDER)) {
             FT_GlyphSlot slot = face->glyph;
-            int y = baseline - slot->bitmap_top;
             int w = slot->bitmap.width, h = slot->bitmap.rows;
-            
-            for (int row = 0; row < h; ++row) {
-                for (int col = 0; col < w; ++col) {
-                    int px = x + slot->bitmap_left + col;
-                    int py = y + row;
-
-                    if (px < 0 || py < 0 || px >= img.cols || py >= img.rows) {
-                        continue;
-                    }
-
-                    uchar alpha = slot->bitmap.buffer[row * w + col];
-                    for (int c = 0; c < img.channels(); ++c) {
-                        img.at<cv::Vec3b>(py, px)[c] = (uchar)((img.at<cv::Vec3b>(py, px)[c] * (255 - alpha) + color[c] * alpha) / 255);
-                    }
+            if (w > 0 && h > 0) {
+                g.bitmap = cv::Mat(h, w, CV_8UC1);
+                for (int row = 0; row < h; ++row) {
+                    std::memcpy(g.bitmap.ptr<uchar>(row), slot->bitmap.buffer + row * slot->bitmap.pitch, w);
                 }
             }
-            x += (slot->advance.x >> 6);
+            g.left = slot->bitmap_left;
+            g.top = slot->bitmap_top;
+            g.advance = slot->advance.x >> 6;
         }
+        return g;
+    }
+
+    const TextRun& layout(const std::string& text) {
+        auto it = runs.find(text);
+        if (it != runs.end()) {
+            return it->second;
+        }
+
+        if (runs.size() >= MAX_CACHED_RUNS) {
+            runs.clear();
+        }
+
+        TextRun run;
+        for (auto cp : utf8_to_codepoints(text)) {
+            const Glyph& g = glyph(cp);
+            run.glyphs.push_back(&g);
+            run.pen_x.push_back(run.width);
+            run.width += g.advance;
+        }
+        return runs.emplace(text, std::move(run)).first->second;
     }
 
 private:
-    FT_Library ftlib = nullptr;
     FT_Face face = nullptr;
+    FT_Size size = nullptr;
     int font_height = 32;
+
+    std::unordered_map<uint64_t, Glyph> glyphs;
+    std::unordered_map<std::string, TextRun> runs;
 };
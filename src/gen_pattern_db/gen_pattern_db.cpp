@@ -0,0 +1,66 @@
+// Builds the disjoint additive pattern databases used by the solver.
+//
+//   gen_pattern_db [size...] [--out dir]
+//
+// Sizes default to 4 and 5. The 4x4 database (6-6-3) needs about 60 MB of memory while
+// building; the 5x5 database (6-6-6-6) needs about 2.5 GB and takes considerably longer.
+
+#include "../core/parallel.hpp"
+#include "../core/pattern_db.hpp"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <charconv>
+#include <iostream>
+
+
+int main(int argc, char** argv) {
+    std::string out_dir = "res";
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out_dir = argv[++i];
+        }
+        else {
+            // Only sizes with a pattern partition are accepted, checked before anything is generated
+            int size = 0;
+            auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), size);
+            if (ec != std::errc() || end != arg.data() + arg.size() || PatternDB::default_patterns(size, size).empty()) {
+                std::cerr << "Usage: gen_pattern_db [4|5...] [--out dir]" << std::endl;
+                return 1;
+            }
+            sizes.push_back(size);
+        }
+    }
+
+    if (sizes.empty()) {
+        sizes = {4, 5};
+    }
+
+    std::cout << "Using " << Parallel::thread_count() << " threads" << std::endl;
+
+    for (int size : sizes) {
+        auto patterns = PatternDB::default_patterns(size, size);
+        if (patterns.empty()) {
+            std::cerr << "No pattern partition defined for " << size << "x" << size << std::endl;
+            return 1;
+        }
+
+        std::string path = out_dir + "/" + PatternDB::file_name(size, size);
+        std::cout << "Generating " << path << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        if (!PatternDB::generate(path, size, size, patterns)) {
+            std::cerr << "Failed to generate " << path << std::endl;
+            return 1;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << path << " in " << seconds << " s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,510 @@
+// Builds res/puzzles.dat and res/puzzles.json from a directory of source images.
+//
+//   gen_puzzle_data [--src src/make_puzzles] [--out res] [--codec jpeg|zlib-jpeg|zlib-bgr] [--quality 95] [--full]
+//   gen_puzzle_data --convert [--out res] [--codec ...] [--quality 95]
+//
+// Images are named `Artist_Name-Painting_Name.jpg` (or .png). They are resized to fit
+// 1280x720, given a chain of small JPEG mip levels for the menu, and encoded on all cores.
+// A content-hash manifest next to the archive records which entry every source became, so
+// a rebuild only re-encodes added or changed images and copies the rest straight from the
+// previous archive. Images are encoded a bounded batch at a time and their bytes streamed to a
+// temporary file that then replaces the old one, so only the index stays in memory. Fields added
+// to puzzles.json by hand or by `calibrate` (block size, difficulty, ...) are kept for unchanged names.
+//
+// --convert upgrades a version 1 archive in place when the source images are not at hand: every
+// catalog entry is inflated from the old archive and stored with its mip levels and index. JPEGs
+// that need no resize keep their original bytes under the jpeg codecs.
+
+#include "../core/parallel.hpp"
+#include "../core/puzzle_archive.hpp"
+
+#include <map>
+#include <span>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+#include <zlib.h>
+#include <nlohmann/json.hpp>
+#include <opencv2/opencv.hpp>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr int MAX_WIDTH = 1280;
+constexpr int MAX_HEIGHT = 720;
+constexpr const char* MANIFEST_FILE = "puzzles.manifest.json";
+constexpr int MANIFEST_VERSION = 1;
+
+struct Settings {
+    ImageFormat format = ImageFormat::JPEG;
+    uint8_t codec = 0;
+    int quality = 95;
+
+    // Entries built with different settings are never reused
+    std::string key() const {
+        return "format=" + std::to_string(static_cast<int>(format)) + " codec=" + std::to_string(codec) +
+               " quality=" + std::to_string(quality) + " max=" + std::to_string(MAX_WIDTH) + "x" + std::to_string(MAX_HEIGHT) +
+               " mips=" + std::to_string(PREVIEW_MIP_LEVELS) + "@" + std::to_string(PREVIEW_MAX_WIDTH) + "x" + std::to_string(PREVIEW_MAX_HEIGHT);
+    }
+};
+
+// One archive record: the full image or one of its mip levels
+struct Record {
+    PuzzleArchiveEntry entry{};
+    std::vector<uint8_t> encoded;      // released once written to the archive
+    int reused = -1;            // record index in the previous archive whose bytes are copied instead
+};
+
+struct Source {
+    fs::path path;
+    std::string file;           // name inside the source directory, the manifest key
+    std::string name, artist;
+    std::string hash;
+    std::span<const uint8_t> legacy;   // zlib-compressed JPEG in a version 1 archive, for --convert
+
+    // The full image followed by PREVIEW_MIP_LEVELS mip levels, reused or freshly encoded
+    std::vector<Record> records;
+    bool reused = false;
+    bool ok = false;
+};
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    size_t end = s.find_last_not_of(" \t");
+    return (begin == std::string::npos) ? std::string() : s.substr(begin, end - begin + 1);
+}
+
+std::string spaces(std::string s) {
+    std::replace(s.begin(), s.end(), '_', ' ');
+    return s;
+}
+
+// `Artist-Title` file stem, either part may be missing
+void parse_name(const fs::path& path, std::string& artist, std::string& name) {
+    std::string base = reinterpret_cast<const char*>(path.stem().u8string().c_str());
+    size_t dash = base.find('-');
+    artist = (dash == std::string::npos) ? "" : trim(base.substr(0, dash));
+    name = trim((dash == std::string::npos) ? base : base.substr(dash + 1));
+
+    artist = artist.empty() ? "Unknown" : spaces(artist);
+    name = name.empty() ? "Untitled" : spaces(name);
+}
+
+bool read_file(const fs::path& path, std::vector<uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Version 1 entries store no uncompressed size, so the buffer grows until the JPEG fits
+bool inflate_legacy(std::span<const uint8_t> compressed, std::vector<uint8_t>& bytes) {
+    if (compressed.empty()) {
+        return false;
+    }
+    bytes.resize(compressed.size() * 4);
+    while (true) {
+        uLongf size = static_cast<uLongf>(bytes.size());
+        int z_result = uncompress(bytes.data(), &size, compressed.data(), static_cast<uLong>(compressed.size()));
+        if (z_result == Z_OK) {
+            bytes.resize(size);
+            return true;
+        }
+        if (z_result != Z_BUF_ERROR) {
+            return false;
+        }
+        bytes.resize(bytes.size() * 2);
+    }
+}
+
+std::string content_hash(const std::vector<uint8_t>& bytes) {
+    char hash[32];
+    uLong crc = crc32(0L, bytes.data(), static_cast<uInt>(bytes.size()));
+    std::snprintf(hash, sizeof(hash), "%08lx-%llx", static_cast<unsigned long>(crc), static_cast<unsigned long long>(bytes.size()));
+    return hash;
+}
+
+// jpeg, if given, is image already encoded and is stored instead of encoding it again
+bool encode_record(Record& record, const cv::Mat& image, ImageFormat format, uint8_t codec, int quality,
+                   const std::vector<uint8_t>* jpeg = nullptr) {
+    std::vector<uint8_t> bytes;
+    if (jpeg) {
+        bytes = *jpeg;
+    }
+    else if (format == ImageFormat::BGR) {
+        bytes.assign(image.data, image.data + image.total() * image.elemSize());
+    }
+    else if (!cv::imencode(".jpg", image, bytes, {cv::IMWRITE_JPEG_QUALITY, quality})) {
+        return false;
+    }
+
+    PuzzleArchiveEntry& e = record.entry;
+    e.uncompressed_size = bytes.size();
+    e.width = static_cast<uint16_t>(image.cols);
+    e.height = static_cast<uint16_t>(image.rows);
+    e.format = static_cast<uint8_t>(format);
+    e.codec = codec;
+
+    if (codec & CODEC_ZLIB) {
+        uLongf size = compressBound(static_cast<uLong>(bytes.size()));
+        record.encoded.resize(size);
+        if (compress(record.encoded.data(), &size, bytes.data(), static_cast<uLong>(bytes.size())) != Z_OK) {
+            return false;
+        }
+        record.encoded.resize(size);
+    }
+    else {
+        record.encoded = std::move(bytes);
+    }
+
+    e.stored_size = record.encoded.size();
+    e.crc32 = static_cast<uint32_t>(crc32(0L, record.encoded.data(), static_cast<uInt>(record.encoded.size())));
+    return true;
+}
+
+bool encode(Source& source, const std::vector<uint8_t>& file_bytes, const Settings& settings) {
+    cv::Mat image = cv::imdecode(file_bytes, cv::IMREAD_COLOR);
+    if (image.empty()) {
+        return false;
+    }
+
+    bool resized = image.cols > MAX_WIDTH || image.rows > MAX_HEIGHT;
+    if (resized) {
+        double scale = std::min(static_cast<double>(MAX_WIDTH) / image.cols, static_cast<double>(MAX_HEIGHT) / image.rows);
+        cv::Size size(std::max(1, static_cast<int>(image.cols * scale)), std::max(1, static_cast<int>(image.rows * scale)));
+        cv::resize(image, image, size, 0, 0, cv::INTER_AREA);
+    }
+
+    // A converted JPEG that fits keeps its bytes, so --convert adds no generation loss
+    bool keep = !source.legacy.empty() && !resized && settings.format == ImageFormat::JPEG;
+
+    source.records.assign(1 + PREVIEW_MIP_LEVELS, Record{});
+    if (!encode_record(source.records[0], image, settings.format, settings.codec, settings.quality, keep ? &file_bytes : nullptr)) {
+        return false;
+    }
+
+    // Level 0 has exactly the size the menu draws the stored image at, so it is shown without resizing
+    int width = 0, height = 0;
+    PuzzleArchive::fit_size(image.cols, image.rows, PREVIEW_MAX_WIDTH, PREVIEW_MAX_HEIGHT, width, height);
+
+    cv::Mat level = image;
+    for (int i = 1; i <= PREVIEW_MIP_LEVELS; ++i) {
+        cv::resize(level, level, cv::Size(std::max(1, width), std::max(1, height)), 0, 0, cv::INTER_AREA);
+        if (!encode_record(source.records[i], level, ImageFormat::JPEG, 0, settings.quality)) {
+            return false;
+        }
+        width /= 2;
+        height /= 2;
+    }
+    return true;
+}
+
+nlohmann::ordered_json read_json(const fs::path& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return {};
+    }
+
+    nlohmann::ordered_json j;
+    try {
+        in >> j;
+    }
+    catch (const nlohmann::json::exception&) {
+        return {};
+    }
+    return j;
+}
+
+bool write_json(const fs::path& path, const nlohmann::ordered_json& j) {
+    std::ofstream out(path, std::ios::trunc);
+    out << j.dump(2) << std::endl;
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    fs::path src_dir = "src/make_puzzles";
+    fs::path out_dir = "res";
+    Settings settings;
+    bool full = false;
+    bool convert = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--src" && i + 1 < argc) {
+            src_dir = argv[++i];
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            out_dir = argv[++i];
+        }
+        else if (arg == "--quality" && i + 1 < argc) {
+            settings.quality = std::clamp(std::stoi(argv[++i]), 1, 100);
+        }
+        else if (arg == "--codec" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (codec == "jpeg")           { settings.format = ImageFormat::JPEG; settings.codec = 0; }
+            else if (codec == "zlib-jpeg") { settings.format = ImageFormat::JPEG; settings.codec = CODEC_ZLIB; }
+            else if (codec == "zlib-bgr")  { settings.format = ImageFormat::BGR;  settings.codec = CODEC_ZLIB; }
+            else {
+                std::cerr << "Unknown codec: " << codec << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--full") {
+            full = true;
+        }
+        else if (arg == "--convert") {
+            convert = true;
+        }
+        else {
+            std::cerr << "Usage: gen_puzzle_data [--src dir] [--out dir] [--codec jpeg|zlib-jpeg|zlib-bgr] [--quality N] [--full | --convert]" << std::endl;
+            return 1;
+        }
+    }
+
+    fs::path dat_path = out_dir / "puzzles.dat";
+    fs::path json_path = out_dir / "puzzles.json";
+    fs::path manifest_path = out_dir / MANIFEST_FILE;
+
+    // The previous archive: copied from on an incremental build, the only image source for --convert
+    PuzzleArchive previous;
+    std::vector<Source> sources;
+    std::error_code ec;
+
+    if (convert) {
+        nlohmann::ordered_json catalog = read_json(json_path);
+        if (!previous.open(dat_path.string()) || previous.version() != 1 || !catalog.contains("puzzles")) {
+            std::cerr << "--convert needs a version 1 archive and its catalog in " << out_dir.string() << std::endl;
+            return 1;
+        }
+        for (const auto& item : catalog.at("puzzles")) {
+            Source source;
+            source.name = item.value("name", "");
+            source.artist = item.value("artist", "");
+            source.path = source.name;
+            source.legacy = previous.view(item.value("offset", uint64_t(0)), item.value("length", uint64_t(0)));
+            sources.push_back(std::move(source));
+        }
+    }
+    else {
+        for (const auto& item : fs::directory_iterator(src_dir, ec)) {
+            std::string ext = item.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (item.is_regular_file() && (ext == ".jpg" || ext == ".jpeg" || ext == ".png")) {
+                Source source;
+                source.path = item.path();
+                source.file = reinterpret_cast<const char*>(item.path().filename().u8string().c_str());
+                parse_name(item.path(), source.artist, source.name);
+                sources.push_back(std::move(source));
+            }
+        }
+        std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.file < b.file; });
+    }
+
+    if (ec || sources.empty()) {
+        std::cerr << "No images found in " << (convert ? dat_path : src_dir).string() << std::endl;
+        return 1;
+    }
+
+    // Catalog: entries whose name and artist did not change keep their position, so saved progress
+    // (stored by catalog index) stays valid, and every extra field such as block_size or difficulty
+    std::map<std::string, std::pair<size_t, nlohmann::ordered_json>> old_entries;
+    nlohmann::ordered_json old_json = read_json(json_path);
+    if (old_json.contains("puzzles")) {
+        for (const auto& item : old_json.at("puzzles")) {
+            std::string key = item.value("name", "") + "|" + item.value("artist", "");
+            old_entries.try_emplace(key, old_entries.size(), item);
+        }
+    }
+
+    auto position = [&](const Source& source) {
+        auto it = old_entries.find(source.name + "|" + source.artist);
+        return (it != old_entries.end()) ? it->second.first : old_entries.size();
+    };
+    std::stable_sort(sources.begin(), sources.end(), [&](const Source& a, const Source& b) { return position(a) < position(b); });
+
+    // Previous build: the manifest maps each source file to its content hash and archive entry
+    std::map<std::string, std::pair<std::string, int>> known;
+    nlohmann::ordered_json manifest = read_json(manifest_path);
+
+    if (!full && !convert && manifest.value("version", 0) == MANIFEST_VERSION && manifest.value("settings", "") == settings.key() &&
+        previous.open(dat_path.string()) && previous.version() >= 2) {
+        for (const auto& item : manifest.at("entries")) {
+            known[item.at("file").get<std::string>()] = {item.at("hash").get<std::string>(), item.at("entry").get<int>()};
+        }
+    }
+
+    // An entry is copied only when it and all of its mip levels are intact
+    auto reusable = [&](int index) {
+        if (index < 0 || index >= previous.entry_count() || previous.mip_levels() != PREVIEW_MIP_LEVELS || !previous.validate(index)) {
+            return false;
+        }
+        for (int level = 0; level < PREVIEW_MIP_LEVELS; ++level) {
+            if (!previous.validate(previous.mip_record(index, level))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::cout << "Processing " << sources.size() << " images on " << Parallel::thread_count() << " threads" << std::endl;
+
+    // Index space is reserved for every source up front. Images that fail to encode leave unused
+    // space between the index and the data, which readers never look at.
+    PuzzleArchiveHeader header{};
+    std::copy(PUZZLE_ARCHIVE_MAGIC, PUZZLE_ARCHIVE_MAGIC + 4, header.magic);
+    header.version = PUZZLE_ARCHIVE_VERSION;
+    header.mip_levels = PREVIEW_MIP_LEVELS;
+    header.index_offset = sizeof(PuzzleArchiveHeader);
+    header.data_offset = header.index_offset + sources.size() * (1 + PREVIEW_MIP_LEVELS) * sizeof(PuzzleArchiveEntry);
+
+    fs::path tmp_path = dat_path;
+    tmp_path += ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    std::vector<char> placeholder(header.data_offset, 0);
+    out.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+
+    // Each batch is encoded on all cores and then appended in catalog order, so the encoded bytes
+    // of at most one batch are held at a time. Each entry's data is followed by its mip levels,
+    // and entries themselves stay in file order.
+    uint64_t offset = header.data_offset;
+    size_t batch = Parallel::thread_count() * 4;
+
+    for (size_t first = 0; first < sources.size(); first += batch) {
+        size_t count = std::min(batch, sources.size() - first);
+
+        Parallel::for_chunks(count, 1, [&](uint64_t begin, uint64_t end) {
+            std::vector<uint8_t> file_bytes;
+            for (uint64_t i = first + begin; i < first + end; ++i) {
+                Source& source = sources[i];
+                if (!(convert ? inflate_legacy(source.legacy, file_bytes) : read_file(source.path, file_bytes))) {
+                    continue;
+                }
+                source.hash = content_hash(file_bytes);
+
+                auto it = known.find(source.file);
+                if (it != known.end() && it->second.first == source.hash && reusable(it->second.second)) {
+                    int index = it->second.second;
+                    source.records.assign(1 + PREVIEW_MIP_LEVELS, Record{});
+                    for (int r = 0; r <= PREVIEW_MIP_LEVELS; ++r) {
+                        source.records[r].reused = (r == 0) ? index : previous.mip_record(index, r - 1);
+                        source.records[r].entry = previous.entry(source.records[r].reused);
+                    }
+                    source.reused = true;
+                    source.ok = true;
+                    continue;
+                }
+
+                source.ok = encode(source, file_bytes, settings);
+            }
+        });
+
+        for (size_t i = first; i < first + count; ++i) {
+            if (!sources[i].ok) {
+                sources[i].records.clear();
+                continue;
+            }
+            for (auto& record : sources[i].records) {
+                std::span<const uint8_t> bytes = (record.reused >= 0)
+                    ? previous.view(previous.entry(record.reused).offset, record.entry.stored_size)
+                    : std::span<const uint8_t>(record.encoded);
+                out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+                record.entry.offset = offset;
+                offset += record.entry.stored_size;
+                record.encoded = std::vector<uint8_t>();
+            }
+        }
+    }
+
+    size_t listed = sources.size();
+    std::erase_if(sources, [](const Source& source) {
+        if (!source.ok) {
+            std::cerr << "Skipping unreadable image: " << source.path.string() << std::endl;
+        }
+        return !source.ok;
+    });
+
+    // Saved progress is stored by catalog index, so a conversion that would drop an entry writes nothing
+    if (convert && sources.size() != listed) {
+        out.close();
+        fs::remove(tmp_path, ec);
+        std::cerr << "Failed to convert " << dat_path.string() << ", left unchanged" << std::endl;
+        return 1;
+    }
+
+    // Header and index go into the reserved space once the surviving entries are known
+    header.entry_count = static_cast<uint32_t>(sources.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& source : sources) {
+        out.write(reinterpret_cast<const char*>(&source.records[0].entry), sizeof(PuzzleArchiveEntry));
+    }
+    for (const auto& source : sources) {
+        for (int level = 1; level <= PREVIEW_MIP_LEVELS; ++level) {
+            out.write(reinterpret_cast<const char*>(&source.records[level].entry), sizeof(PuzzleArchiveEntry));
+        }
+    }
+    out.close();
+
+    // Reused bytes come from the old mapping, which must be released before the file is replaced
+    previous = PuzzleArchive();
+    if (out) {
+        fs::rename(tmp_path, dat_path, ec);
+    }
+    if (!out || ec) {
+        std::cerr << "Failed to write " << dat_path.string() << std::endl;
+        return 1;
+    }
+
+    nlohmann::ordered_json puzzles = nlohmann::ordered_json::array();
+    nlohmann::ordered_json manifest_entries = nlohmann::ordered_json::array();
+    int reused = 0;
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const Source& source = sources[i];
+        auto it = old_entries.find(source.name + "|" + source.artist);
+
+        nlohmann::ordered_json item = (it != old_entries.end()) ? it->second.second : nlohmann::ordered_json::object();
+        item["name"] = source.name;
+        item["artist"] = source.artist;
+        item["entry"] = i;
+        item["offset"] = source.records[0].entry.offset;
+        item["length"] = source.records[0].entry.stored_size;
+        puzzles.push_back(item);
+
+        manifest_entries.push_back({{"file", source.file}, {"hash", source.hash}, {"entry", i}});
+        reused += source.reused;
+    }
+
+    // Converted entries have no source file, so the next build from sources encodes every image
+    manifest = {{"version", MANIFEST_VERSION}, {"settings", settings.key()}, {"entries", manifest_entries}};
+    if (convert) {
+        fs::remove(manifest_path, ec);
+    }
+    if (!write_json(json_path, {{"puzzles", puzzles}}) || (!convert && !write_json(manifest_path, manifest))) {
+        std::cerr << "Failed to write " << json_path.string() << " or " << manifest_path.string() << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Wrote " << sources.size() << " entries (" << sources.size() - reused << " encoded, " << reused
+              << " reused, " << offset / 1024 << " KiB) in " << seconds << " s" << std::endl;
+    return 0;
+}
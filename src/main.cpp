@@ -1,7 +1,10 @@
 #include "app.hpp"
+#include "core/startup_trace.hpp"
 
 int main() {
+    StartupTrace::begin();
     App app;
+    StartupTrace::mark("app constructed");
     app.run();
     return 0;
 }
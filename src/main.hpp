@@ -2,15 +2,24 @@
 
 #include <string>
 #include <memory>
+#include <cstddef>
+
+#include "core/board.hpp"
 
 #include <nlohmann/json.hpp>
 #include <opencv2/opencv.hpp>
 
+class HintEngine;
+
 constexpr const char* WIN_NAME = "ReVision Sliding Puzzle";
 constexpr const char* FONT_FILE = "res/NotoSansJP-Regular.ttf";
+constexpr int TEXT_FONT_HEIGHT = 32;
 constexpr const char* PUZZLE_STATE_FILE = "res/puzzle_state";
 constexpr const char* PUZZLE_DATA_FILE = "res/puzzles.dat";
 constexpr const char* PUZZLE_META_FILE = "res/puzzles.json";
+constexpr const char* PATTERN_DB_DIR = "res";
+constexpr const char* PREVIEW_THUMBNAIL_FILE = "res/cache/previews.bin";
+constexpr std::size_t PREVIEW_CACHE_BUDGET = 64 * 1024 * 1024;     // decoded menu previews, about 70 at 740x416
 
 struct MouseState {
     int block_width, block_height, cols, rows;
@@ -20,10 +29,12 @@ struct MouseState {
     const cv::Mat &image_original;
 
     std::vector<cv::Rect> &blocks;
-    std::vector<int>* perm = nullptr;
+    Board* board = nullptr;
 
     bool solved = false;
     std::string puzzle_key;
+
+    HintEngine* hints = nullptr;
 };
 
 struct ClickState {
@@ -43,6 +54,10 @@ struct PuzzleMeta {
     int offset;
     int length;
     int block_size;
+
+    // Filled from a version 2 archive index
+    int entry = -1;
+    int width = 0, height = 0;
 };
 
 struct PageClickParams {
@@ -69,9 +84,8 @@ struct PuzzleSession {
     PuzzleLayout layout;
 
     std::vector<cv::Rect> blocks;
-    std::vector<int> perm;
+    Board board;
 
-    int empty_idx;
     cv::Mat image_original;
 };
 
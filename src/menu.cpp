@@ -3,6 +3,10 @@
 #include "app.hpp"
 #include "state.hpp"
 #include "puzzle.hpp"
+#include "event_loop.hpp"
+#include "font_manager.hpp"
+#include "core/startup_trace.hpp"
+#include "core/puzzle_archive.hpp"
 
 #include <map>
 #include <string>
@@ -13,7 +17,10 @@
 #include <opencv2/opencv.hpp>
 
 
-Menu::Menu() : ft2(FONT_FILE), hover("none"), current_page(0) {}
+// The builder fits mip level 0 to the preview area, so the menu can draw it unscaled
+static_assert(PREVIEW_MAX_WIDTH == WIN_W - 2 * MARGIN - 2 * BTN_W && PREVIEW_MAX_HEIGHT == WIN_H - 220, "archive previews must match the menu preview area");
+
+Menu::Menu() : ft2(FontManager::instance().renderer(FONT_FILE, TEXT_FONT_HEIGHT)), hover("none"), current_page(0) {}
 
 void Menu::calc_preview_layout(int thumb_w, int thumb_h, int win_w, int win_h, const cv::Mat& thumb_src, int& draw_w, int& draw_h, int& img_x, int& img_y) {
     double aspect = static_cast<double>(thumb_src.cols) / thumb_src.rows;
@@ -99,7 +106,7 @@ void Menu::draw_puzzle_info(cv::Mat& canvas, const PuzzleMeta& meta, int idx, in
     ft2.draw_text(canvas, meta.difficulty, cv::Point(win_w - diff_sz.width - 40, win_h - 30), diff_color, 2);
 }
 
-MenuLayout Menu::compute_menu_layout(const cv::Mat& preview) {
+MenuLayout Menu::compute_menu_layout(const PuzzleMeta& meta, const cv::Mat& preview) {
     MenuLayout menu_layout {
         .win_w = WIN_W,
         .win_h = WIN_H,
@@ -114,27 +121,11 @@ MenuLayout Menu::compute_menu_layout(const cv::Mat& preview) {
     int preview_area_y = menu_layout.y_offset;
     int preview_area_w = menu_layout.thumb_w;
     int preview_area_h = menu_layout.thumb_h;
-    double aspect = static_cast<double>(preview.cols) / preview.rows;
     int draw_w = preview_area_w, draw_h = preview_area_h;
-    
-    if (aspect > 1.0) {
-        draw_w = preview_area_w;
-        draw_h = static_cast<int>(draw_w / aspect);
-
-        if (draw_h > preview_area_h) {
-            draw_h = preview_area_h;
-            draw_w = static_cast<int>(draw_h * aspect);
-        }
-    }
-    else {
-        draw_h = preview_area_h;
-        draw_w = static_cast<int>(draw_h * aspect);
 
-        if (draw_w > preview_area_w) {
-            draw_w = preview_area_w;
-            draw_h = static_cast<int>(draw_w / aspect);
-        }
-    }
+    // The full image size from the archive index, which the stored mip levels were fitted from
+    bool indexed = meta.width > 0 && meta.height > 0;
+    PuzzleArchive::fit_size(indexed ? meta.width : preview.cols, indexed ? meta.height : preview.rows, preview_area_w, preview_area_h, draw_w, draw_h);
 
     menu_layout.draw_w = draw_w;
     menu_layout.draw_h = draw_h;
@@ -149,7 +140,7 @@ MenuLayout Menu::compute_menu_layout(const cv::Mat& preview) {
 }
 
 // Draws the main menu UI
-cv::Mat Menu::draw_menu(const MenuLayout& menu_layout, int idx, int total_pages, const std::string& hover, const std::vector<PuzzleMeta>& metas, const std::vector<cv::Mat>& previews, const std::map<std::string, bool>& solved_map) {
+cv::Mat Menu::draw_menu(const MenuLayout& menu_layout, int idx, int total_pages, const std::string& hover, const std::vector<PuzzleMeta>& metas, const cv::Mat& preview, const std::map<std::string, bool>& solved_map) {
 
     // Ensure window is created and resized for the menu
     cv::namedWindow(WIN_NAME, cv::WINDOW_AUTOSIZE);
@@ -158,9 +149,17 @@ cv::Mat Menu::draw_menu(const MenuLayout& menu_layout, int idx, int total_pages,
     std::string nav = std::to_string(idx+1) + "/" + std::to_string(total_pages);
     ft2.draw_text(canvas, nav, cv::Point(menu_layout.win_w/2, menu_layout.nav_y), cv::Scalar(255,255,255), 2, true);
 
-    // Preview image
-    cv::Mat thumb;
-    cv::resize(previews[idx], thumb, cv::Size(menu_layout.draw_w, menu_layout.draw_h));
+    // Preview image, resized only when its mip level does not already have the drawn size
+    cv::Size draw_size(menu_layout.draw_w, menu_layout.draw_h);
+    if (thumb_source.data != preview.data || thumb.size() != draw_size) {
+        if (preview.size() == draw_size) {
+            thumb = preview;
+        }
+        else {
+            cv::resize(preview, thumb, draw_size, 0, 0, cv::INTER_AREA);
+        }
+        thumb_source = preview;
+    }
     thumb.copyTo(canvas(cv::Rect(menu_layout.img_x, menu_layout.img_y, menu_layout.draw_w, menu_layout.draw_h)));
     cv::Scalar border_color(80,140,220);
     cv::Scalar hover_color(180,220,255);
@@ -177,12 +176,10 @@ cv::Mat Menu::draw_menu(const MenuLayout& menu_layout, int idx, int total_pages,
 
     // Draw puzzle info
     draw_puzzle_info(canvas, metas[idx], idx, menu_layout.win_w, menu_layout.win_h, menu_layout.y_offset, menu_layout.thumb_h, solved_map);
-    cv::imshow(WIN_NAME, canvas);
-
     return canvas;
 }
 
-// Helper to set up mouse callback and buffer
+// Builds the userdata of App::main_menu_mouse_callback, to which the event loop dispatches mouse events
 char* Menu::setup_main_menu_mouse_callback(const MenuLayout& menu_layout, int idx, int total_pages, MenuCallbackState& state) {
     size_t buf_size = sizeof(PageClickParams) + sizeof(std::string*);
     char* cb_data = new char[buf_size];
@@ -197,54 +194,74 @@ char* Menu::setup_main_menu_mouse_callback(const MenuLayout& menu_layout, int id
     memcpy(cb_data, &cb_params, sizeof(PageClickParams));
     std::string** hover_ptr_ptr = reinterpret_cast<std::string**>(cb_data + sizeof(PageClickParams));
     *hover_ptr_ptr = state.hover;
-    cv::setMouseCallback(WIN_NAME, App::main_menu_mouse_callback, cb_data);
     return cb_data;
 }
 
 // Show the main menu with puzzle previews and navigation
-int Menu::show(const std::vector<PuzzleMeta>& metas, const std::vector<cv::Mat>& previews, int page, const std::map<std::string, bool>& solved_map) {
+int Menu::show(const std::vector<PuzzleMeta>& metas, PreviewCache& previews, SessionPrefetcher& sessions, int page, const std::map<std::string, bool>& solved_map) {
     current_page = page;
     int total_pages = static_cast<int>(metas.size());
-    std::string last_hover = hover;
+    EventLoop loop(WIN_NAME);
 
     while (true) {
-        MenuLayout menu_layout = compute_menu_layout(previews[current_page]);
+        // A placeholder stands in until the preview is decoded, then the page is laid out again
+        bool loaded = previews.ready(current_page);
+        cv::Mat preview = previews.get(current_page);
+        previews.request(current_page + 1);
+        previews.request(current_page - 1);
+        sessions.focus(current_page);
+
+        MenuLayout menu_layout = compute_menu_layout(metas[current_page], preview);
         MenuCallbackState cb_state{ -1, 0, &hover };
-        last_hover = hover;
 
-        cv::Mat canvas = draw_menu(menu_layout, current_page, total_pages, hover, metas, previews, solved_map);
+        loop.present(draw_menu(menu_layout, current_page, total_pages, hover, metas, preview, solved_map));
+        StartupTrace::mark("first menu frame");
+        if (loaded) {
+            StartupTrace::mark("first preview frame");
+            StartupTrace::print_if_enabled();
+        }
         char* cb_data = setup_main_menu_mouse_callback(menu_layout, current_page, total_pages, cb_state);
 
-        while (cb_state.selected == -1 && cb_state.nav_dir == 0) {
-            int key = cv::waitKey(1);
-            if (cv::getWindowProperty(WIN_NAME, cv::WND_PROP_VISIBLE) < 1 || key == 27) {
+        // Save last selected preview on every page change
+        static int last_saved_page = -1;
+        if (current_page != last_saved_page) {
+
+            // Build solved_indices for saving
+            std::vector<int> solved_indices;
+            for (size_t i = 0; i < metas.size(); ++i) {
+                std::string key = metas[i].name + "|" + metas[i].artist;
+                if (solved_map.count(key) && solved_map.at(key)) {
+                    solved_indices.push_back((int)i);
+                }
+            }
+            State::save(solved_indices, current_page);
+            last_saved_page = current_page;
+        }
+
+        // Sleeps until input arrives; a placeholder page also wakes once a frame to check for its preview
+        while (cb_state.selected == -1 && cb_state.nav_dir == 0 && (loaded || !previews.ready(current_page))) {
+            UiEvent event;
+            if (!loop.next(event, loaded ? EventLoop::FOREVER : EventLoop::FRAME_MS)) {
+                continue;
+            }
+
+            if (event.type == UiEvent::CLOSED || (event.type == UiEvent::KEY && event.code == 27)) {
                 delete[] cb_data;
                 return -1;
             }
 
-            if (hover != last_hover) {
-                last_hover = hover;
-                canvas = draw_menu(menu_layout, current_page, total_pages, hover, metas, previews, solved_map);
+            if (event.type == UiEvent::MOUSE) {
+                std::string last_hover = hover;
+                App::main_menu_mouse_callback(event.code, event.x, event.y, event.flags, cb_data);
+                if (hover != last_hover) {
+                    loop.invalidate();
+                }
             }
 
-            // Save last selected preview on every highlight change
-            static int last_saved_page = -1;
-            if (current_page != last_saved_page) {
-
-                // Build solved_indices for saving
-                std::vector<int> solved_indices;
-                for (size_t i = 0; i < metas.size(); ++i) {
-                    std::string key = metas[i].name + "|" + metas[i].artist;
-                    if (solved_map.count(key) && solved_map.at(key)) {
-                        solved_indices.push_back((int)i);
-                    }
-                }
-                State::save(solved_indices, current_page);
-                last_saved_page = current_page;
+            if (loop.dirty() && !loop.pending()) {
+                loop.present(draw_menu(menu_layout, current_page, total_pages, hover, metas, preview, solved_map));
             }
         }
-        
-        cv::setMouseCallback(WIN_NAME, nullptr, nullptr);
 
         delete[] cb_data;
         if (cb_state.selected != -1) {
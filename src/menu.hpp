@@ -2,6 +2,8 @@
 
 #include "ft2.hpp"
 #include "main.hpp"
+#include "preview_cache.hpp"
+#include "session_prefetcher.hpp"
 
 #include <string>
 #include <vector>
@@ -35,13 +37,17 @@ struct MenuCallbackState {
 class Menu {
 public:
     Menu();
-    int show(const std::vector<PuzzleMeta>& metas, const std::vector<cv::Mat>& previews, int page, const std::map<std::string, bool>& solved_map);
+    int show(const std::vector<PuzzleMeta>& metas, PreviewCache& previews, SessionPrefetcher& sessions, int page, const std::map<std::string, bool>& solved_map);
     
 private:
-    FT2TextRenderer ft2;
+    FT2TextRenderer& ft2;
     std::string hover;
     int current_page;
 
+    // thumb_source at its drawn size, kept across redraws until the page or its preview changes
+    cv::Mat thumb;
+    cv::Mat thumb_source;
+
 private:
     void calc_preview_layout(int thumb_w, int thumb_h, int win_w, int win_h, const cv::Mat& thumb_src, int& draw_w, int& draw_h, int& img_x, int& img_y);
 
@@ -49,9 +55,9 @@ private:
 
     void draw_puzzle_info(cv::Mat& canvas, const PuzzleMeta& meta, int idx, int win_w, int win_h, int y_offset, int thumb_h, const std::map<std::string, bool>& solved_map);
 
-    MenuLayout compute_menu_layout(const cv::Mat& preview);
+    MenuLayout compute_menu_layout(const PuzzleMeta& meta, const cv::Mat& preview);
 
-    cv::Mat draw_menu(const MenuLayout& menu_layout, int idx, int total_pages, const std::string& hover, const std::vector<PuzzleMeta>& metas, const std::vector<cv::Mat>& previews, const std::map<std::string, bool>& solved_map);
+    cv::Mat draw_menu(const MenuLayout& menu_layout, int idx, int total_pages, const std::string& hover, const std::vector<PuzzleMeta>& metas, const cv::Mat& preview, const std::map<std::string, bool>& solved_map);
 
     char* setup_main_menu_mouse_callback(const MenuLayout& menu_layout, int idx, int total_pages, MenuCallbackState& state);
 };
@@ -0,0 +1,91 @@
+#include "overlay.hpp"
+
+#include "core/blend.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+
+void Overlay::dim(cv::Mat& mat, const cv::Rect& rect, double amount) {
+    cv::Rect clipped = rect & cv::Rect(0, 0, mat.cols, mat.rows);
+    if (clipped.empty()) {
+        return;
+    }
+
+    // The ROI shares the frame's pixels, so this scales them in place
+    cv::Mat roi = mat(clipped);
+    roi.convertTo(roi, -1, 1.0 - amount);
+}
+
+OverlaySprite Overlay::make_banner(FT2TextRenderer& ft2, const std::string& line1, const std::string& line2, int font_height1, int font_height2) {
+    int thickness = 2;
+    int font = cv::FONT_HERSHEY_SIMPLEX;
+    int baseline = 0;
+    double scale1 = font_height1 / 32.0, scale2 = font_height2 / 32.0;
+
+    // Box size from the Hershey metrics of the two lines
+    cv::Size sz1 = cv::getTextSize(line1, font, scale1, thickness, &baseline);
+    cv::Size sz2 = cv::getTextSize(line2, font, scale2, thickness, &baseline);
+    int box_w = std::max(sz1.width, sz2.width) + 60;
+    int box_h = sz1.height + sz2.height + 60;
+
+    // Baselines relative to the box, text centered on it
+    int cx = box_w / 2;
+    int text1_y = 30 + sz1.height;
+    int text2_y = text1_y + sz2.height + 10;
+
+    // Grow the sprite to cover text that reaches past the box; a glyph stays within two
+    // font heights above its baseline and one below
+    int em = ft2.pixel_height();
+    int half_w = std::max(ft2.text_width(line1), ft2.text_width(line2)) / 2 + em;
+    cv::Rect area = cv::Rect(0, 0, box_w, box_h)
+        | cv::Rect(cx - half_w, text1_y - 2 * em, 2 * half_w, text2_y - text1_y + 3 * em);
+
+    OverlaySprite sprite;
+    sprite.size = area.size();
+    sprite.box = cv::Rect(-area.x, -area.y, box_w, box_h);
+    sprite.center_offset = cv::Point(-box_w / 2 + area.x, -(sz1.height + sz2.height) / 2 - 30 + area.y);
+
+    auto add_layer = [&](const std::string& text, int y, const cv::Scalar& color) {
+        if (text.empty()) {
+            return;
+        }
+        cv::Mat coverage(sprite.size, CV_8UC1, cv::Scalar(0));
+        ft2.draw_text(coverage, text, cv::Point(cx - area.x, y - area.y), cv::Scalar(255), 2, true);
+        sprite.layers.push_back({coverage, color});
+    };
+    add_layer(line1, text1_y, cv::Scalar(255, 255, 80));
+    add_layer(line2, text2_y, cv::Scalar(255, 255, 255));
+    return sprite;
+}
+
+void Overlay::draw(cv::Mat& mat, const OverlaySprite& sprite) {
+    draw(mat, sprite, cv::Point(mat.cols / 2, mat.rows / 2) + sprite.center_offset);
+}
+
+void Overlay::draw(cv::Mat& mat, const OverlaySprite& sprite, cv::Point origin) {
+    if (mat.depth() != CV_8U || mat.channels() > 4) {
+        return;
+    }
+
+    dim(mat, sprite.box + origin, sprite.dim);
+
+    cv::Rect clipped = cv::Rect(origin, sprite.size) & cv::Rect(0, 0, mat.cols, mat.rows);
+    if (clipped.empty()) {
+        return;
+    }
+
+    for (const auto& layer : sprite.layers) {
+        uint8_t pen[4];
+        for (int c = 0; c < 3; ++c) {
+            pen[c] = cv::saturate_cast<uint8_t>(layer.color[c]);
+        }
+        pen[3] = 255;       // opaque on 4-channel images, as in FT2TextRenderer::draw_text
+        Blend::coverage(mat.ptr<uint8_t>(clipped.y, clipped.x), mat.step, mat.channels(),
+                        layer.coverage.ptr<uint8_t>(clipped.y - origin.y, clipped.x - origin.x), layer.coverage.step,
+                        clipped.width, clipped.height, pen);
+    }
+}
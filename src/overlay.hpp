@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ft2.hpp"
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// A text banner rendered once: a translucent dark box and the coverage of each text line.
+// Positions are relative to the sprite's top-left corner, which may extend past the box
+// where text is wider than it.
+struct OverlaySprite {
+    struct Layer {
+        cv::Mat coverage;           // CV_8UC1, sprite-sized
+        cv::Scalar color;
+    };
+
+    cv::Size size;
+    cv::Rect box;
+    double dim = 0.6;               // fraction of the background removed under the box
+    cv::Point center_offset;        // sprite top-left relative to the center of the frame
+
+    std::vector<Layer> layers;
+};
+
+// Composites translucent overlays into a frame in place, touching only the pixels they cover
+class Overlay {
+public:
+    // Darkens rect, clipped to the image, by the given fraction
+    static void dim(cv::Mat& mat, const cv::Rect& rect, double amount);
+
+    // Two centered lines in a dark box, laid out like the start and solved screens always were
+    static OverlaySprite make_banner(FT2TextRenderer& ft2, const std::string& line1, const std::string& line2, int font_height1, int font_height2);
+
+    // Draws the sprite centered on the frame, clipped to it
+    static void draw(cv::Mat& mat, const OverlaySprite& sprite);
+    static void draw(cv::Mat& mat, const OverlaySprite& sprite, cv::Point origin);
+};
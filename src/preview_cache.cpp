@@ -0,0 +1,159 @@
+#include "preview_cache.hpp"
+
+#include "puzzle.hpp"
+#include "core/puzzle_archive.hpp"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+
+PreviewCache::PreviewCache(const std::string& dat_path, const std::string& cache_path, const std::vector<PuzzleMeta>& metas, size_t budget_bytes, int width, int height)
+    : dat_path(dat_path), metas(metas), budget(budget_bytes), width(width), height(height), pending(metas.size(), false) {
+    thumbnails.open(cache_path, dat_path, metas, width, height);
+
+    unsigned threads = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_THREADS);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&PreviewCache::worker_loop, this);
+    }
+}
+
+PreviewCache::~PreviewCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Unmaps the cached thumbnails, none of them may be in use any more
+    thumbnails.save();
+}
+
+cv::Mat PreviewCache::get(int index) {
+    cv::Mat cached = thumbnails.find(index);
+    if (!cached.empty()) {
+        return cached;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = slots.find(index);
+    if (it != slots.end()) {
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second.image;
+    }
+
+    enqueue(index, true);
+    lock.unlock();
+    return placeholder(index);
+}
+
+bool PreviewCache::ready(int index) {
+    if (!thumbnails.find(index).empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return slots.contains(index);
+}
+
+void PreviewCache::request(int index) {
+    if (!thumbnails.find(index).empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!slots.contains(index)) {
+        enqueue(index, false);
+    }
+}
+
+size_t PreviewCache::memory_used() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+void PreviewCache::enqueue(int index, bool urgent) {
+    if (index < 0 || index >= static_cast<int>(metas.size())) {
+        return;
+    }
+
+    // An urgent request jumps ahead of prefetches queued earlier; one already being decoded stays put
+    if (pending[index]) {
+        auto it = std::find(queue.begin(), queue.end(), index);
+        if (!urgent || it == queue.end()) {
+            return;
+        }
+        queue.erase(it);
+    }
+
+    if (urgent) {
+        queue.push_front(index);
+    }
+    else {
+        queue.push_back(index);
+    }
+    pending[index] = true;
+    wake.notify_one();
+}
+
+void PreviewCache::insert(int index, cv::Mat image) {
+    lru.push_front(index);
+    used += image.total() * image.elemSize();
+    slots[index] = Slot{std::move(image), lru.begin()};
+
+    // The newest preview always stays, even when it alone exceeds the budget
+    while (used > budget && lru.size() > 1) {
+        auto victim = slots.find(lru.back());
+        used -= victim->second.image.total() * victim->second.image.elemSize();
+        slots.erase(victim);
+        lru.pop_back();
+    }
+}
+
+cv::Mat PreviewCache::placeholder(int index) const {
+    const PuzzleMeta& meta = metas[index];
+    int fit_w = width, fit_h = height;
+    if (meta.width > 0 && meta.height > 0) {
+        PuzzleArchive::fit_size(meta.width, meta.height, width, height, fit_w, fit_h);
+    }
+    return cv::Mat(std::max(1, fit_h), std::max(1, fit_w), CV_8UC3, cv::Scalar(50, 50, 50));
+}
+
+void PreviewCache::worker_loop() {
+    while (true) {
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+
+            index = queue.front();
+            queue.pop_front();
+            if (slots.contains(index)) {
+                pending[index] = false;
+                continue;
+            }
+        }
+
+        cv::Mat image = Puzzle::load_preview(dat_path, metas[index], width, height);
+        if (image.empty()) {
+            std::cerr << "Failed to load preview for: " << metas[index].name << std::endl;
+            image = placeholder(index);
+        }
+        else {
+            thumbnails.add(index, image);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        insert(index, std::move(image));
+        pending[index] = false;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "main.hpp"
+#include "thumbnail_cache.hpp"
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <opencv2/opencv.hpp>
+
+// Menu previews decoded on demand by a small pool of background threads and kept in an LRU list within a
+// memory budget. Lookups never block: an image that is not decoded yet is queued and a gray
+// placeholder of the same size is returned until it is ready. Decoded previews are also kept
+// in an on-disk ThumbnailCache, which serves them directly from a mapping on the next start.
+class PreviewCache {
+public:
+    static constexpr unsigned MAX_THREADS = 4;
+
+    PreviewCache(const std::string& dat_path, const std::string& cache_path, const std::vector<PuzzleMeta>& metas, size_t budget_bytes, int width, int height);
+    ~PreviewCache();
+
+    PreviewCache(const PreviewCache&) = delete;
+    PreviewCache& operator=(const PreviewCache&) = delete;
+
+    // The cached or decoded preview, or a placeholder while it is decoded ahead of every other request.
+    // Read-only: thumbnails from the disk cache are mapped pixels.
+    cv::Mat get(int index);
+    bool ready(int index);
+
+    // Queues the preview behind earlier requests, e.g. for the neighbouring pages
+    void request(int index);
+
+    size_t memory_used();
+
+private:
+    struct Slot {
+        cv::Mat image;
+        std::list<int>::iterator lru;
+    };
+
+    void enqueue(int index, bool urgent);
+    void insert(int index, cv::Mat image);
+    cv::Mat placeholder(int index) const;
+    void worker_loop();
+
+private:
+    std::string dat_path;
+    std::vector<PuzzleMeta> metas;
+    size_t budget;
+    int width, height;
+
+    ThumbnailCache thumbnails;          // read-only after construction, apart from its own locked add()
+
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    std::unordered_map<int, Slot> slots;
+    std::list<int> lru;                     // most recently used first
+    size_t used = 0;
+
+    std::deque<int> queue;
+    std::vector<bool> pending;              // queued or being decoded
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
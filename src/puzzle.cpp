@@ -1,13 +1,20 @@
 #include "puzzle.hpp"
 
 #include "app.hpp"
+#include "event_loop.hpp"
 #include "ft2.hpp"
 #include "main.hpp"
 #include "util.hpp"
+#include "core/hint.hpp"
+#include "core/solver.hpp"
+#include "core/shuffler.hpp"
+#include "core/puzzle_archive.hpp"
 
+#include <span>
 #include <random>
 #include <string>
 #include <vector>
+#include <memory>
 #include <fstream>
 #include <numeric>
 #include <iostream>
@@ -17,6 +24,114 @@
 #include <opencv2/opencv.hpp>
 
 
+namespace {
+
+// Version 1 archives store no uncompressed size, so the buffer is grown until the JPEG fits
+cv::Mat load_legacy_image(const PuzzleArchive& archive, const PuzzleMeta& meta) {
+    std::span<const uint8_t> compressed = archive.view(meta.offset, meta.length);
+    if (compressed.empty()) {
+        std::cerr << "Failed to read compressed data for puzzle: " << meta.name << std::endl;
+        return cv::Mat();
+    }
+
+    uLongf uncompressed_size = meta.length * 20;
+    std::vector<uchar> uncompressed;
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        uncompressed.resize(uncompressed_size);
+        int z_result = uncompress(uncompressed.data(), &uncompressed_size, compressed.data(), static_cast<uLong>(compressed.size()));
+
+        if (z_result == Z_OK) {
+            uncompressed.resize(uncompressed_size);
+            return cv::imdecode(uncompressed, cv::IMREAD_COLOR);
+        }
+        uncompressed_size *= 2;
+    }
+
+    std::cerr << "Decompression failed for puzzle: " << meta.name << std::endl;
+    return cv::Mat();
+}
+
+// Largest libjpeg scale-down (1/8, 1/4 or 1/2) whose output still covers width x height, as an imdecode flag
+int reduced_decode_flag(int image_width, int image_height, int width, int height) {
+    if (width <= 0 || height <= 0 || image_width <= 0 || image_height <= 0) {
+        return cv::IMREAD_COLOR;
+    }
+
+    constexpr std::pair<int, int> REDUCTIONS[] = {
+        {8, cv::IMREAD_REDUCED_COLOR_8}, {4, cv::IMREAD_REDUCED_COLOR_4}, {2, cv::IMREAD_REDUCED_COLOR_2}
+    };
+    for (const auto& [factor, flag] : REDUCTIONS) {
+        if ((image_width + factor - 1) / factor >= width && (image_height + factor - 1) / factor >= height) {
+            return flag;
+        }
+    }
+    return cv::IMREAD_COLOR;
+}
+
+// Scales image to the size a full_width x full_height image has when fitted into width x height
+cv::Mat fit_image(const cv::Mat& image, int full_width, int full_height, int width, int height) {
+    if (image.empty() || width <= 0 || height <= 0) {
+        return image;
+    }
+
+    int fit_width = width, fit_height = height;
+    PuzzleArchive::fit_size(full_width, full_height, width, height, fit_width, fit_height);
+    cv::Size size(std::max(1, fit_width), std::max(1, fit_height));
+    if (image.size() == size) {
+        return image;
+    }
+
+    cv::Mat fitted;
+    cv::resize(image, fitted, size, 0, 0, cv::INTER_AREA);
+    return fitted;
+}
+
+// Decodes one record of a version 2 archive, either an entry or one of its mip levels, fitted
+// into width x height unless both are 0
+cv::Mat load_record(const PuzzleArchive& archive, int record, const PuzzleMeta& meta, int width, int height) {
+    // Fitting follows the full image's aspect, as the menu layout does
+    const PuzzleArchiveEntry& entry = archive.entry(record);
+    bool indexed = meta.width > 0 && meta.height > 0;
+    int full_width = indexed ? meta.width : entry.width;
+    int full_height = indexed ? meta.height : entry.height;
+
+    // Raw pixels need no decode: they are inflated (or copied) straight into the image
+    if (entry.format == static_cast<uint8_t>(ImageFormat::BGR)) {
+        cv::Mat image(entry.height, entry.width, CV_8UC3);
+        if (entry.uncompressed_size != image.total() * image.elemSize() ||
+            !archive.extract_to(record, std::span<uint8_t>(image.data, image.total() * image.elemSize()))) {
+            std::cerr << "Corrupt archive entry for puzzle: " << meta.name << std::endl;
+            return cv::Mat();
+        }
+        return fit_image(image, full_width, full_height, width, height);
+    }
+
+    std::vector<uint8_t> buffer;
+    std::span<const uint8_t> bytes = archive.extract(record, buffer);
+    if (bytes.empty()) {
+        std::cerr << "Corrupt archive entry for puzzle: " << meta.name << std::endl;
+        return cv::Mat();
+    }
+
+    // imdecode reads straight from the mapping (or the inflated buffer), no further copy. A
+    // reduced JPEG decode skips most of the IDCT work, leaving a much smaller image to resize.
+    cv::Mat encoded(1, static_cast<int>(bytes.size()), CV_8UC1, const_cast<uint8_t*>(bytes.data()));
+    int flag = cv::IMREAD_COLOR;
+    if (entry.format == static_cast<uint8_t>(ImageFormat::JPEG) && width > 0 && height > 0 && full_width > 0 && full_height > 0) {
+        // The fitted size, in pixels of this record
+        int fit_width = width, fit_height = height;
+        PuzzleArchive::fit_size(full_width, full_height, width, height, fit_width, fit_height);
+        int need_width = (fit_width * entry.width + full_width - 1) / full_width;
+        int need_height = (fit_height * entry.height + full_height - 1) / full_height;
+        flag = reduced_decode_flag(entry.width, entry.height, need_width, need_height);
+    }
+    return fit_image(cv::imdecode(encoded, flag), full_width, full_height, width, height);
+}
+
+} // namespace
+
+
 std::vector<PuzzleMeta> Puzzle::load_meta(const std::string& json_path) {
     std::ifstream f(json_path);
     if (!f) {
@@ -34,51 +149,76 @@ std::vector<PuzzleMeta> Puzzle::load_meta(const std::string& json_path) {
             entry.value("difficulty", "medium"),
             entry.at("offset").get<int>(),
             entry.at("length").get<int>(),
-            entry.value("block_size", 3)
+            entry.value("block_size", 3),
+            entry.value("entry", -1)
         );
     }
     return puzzles;
 }
 
-cv::Mat Puzzle::load_image(const std::string& dat_path, const PuzzleMeta& meta) {
-    std::ifstream dat(dat_path, std::ios::binary);
-    if (!dat) {
+void Puzzle::resolve_entries(const std::string& dat_path, std::vector<PuzzleMeta>& metas) {
+    const PuzzleArchive* archive = PuzzleArchive::find(dat_path);
+    if (!archive || archive->version() < 2) {
+        return;
+    }
+
+    for (auto& meta : metas) {
+        if (meta.entry < 0) {
+            meta.entry = archive->find_entry(static_cast<uint64_t>(meta.offset));
+        }
+        if (meta.entry >= 0 && meta.entry < archive->entry_count()) {
+            meta.width = archive->entry(meta.entry).width;
+            meta.height = archive->entry(meta.entry).height;
+        }
+        else {
+            meta.entry = -1;
+        }
+    }
+}
+
+cv::Mat Puzzle::load_image(const std::string& dat_path, const PuzzleMeta& meta, int width, int height) {
+    const PuzzleArchive* archive = PuzzleArchive::find(dat_path);
+    if (!archive) {
         std::cerr << "Failed to open data file: " << dat_path << std::endl;
         return cv::Mat();
     }
 
-    dat.seekg(meta.offset);
-    std::vector<uchar> compressed(meta.length);
-    if (!dat.read(reinterpret_cast<char*>(compressed.data()), meta.length)) {
-        std::cerr << "Failed to read compressed data for puzzle: " << meta.name << std::endl;
-        return cv::Mat();
+    // Legacy entries carry no image size, so they are always decoded in full
+    if (archive->version() < 2) {
+        cv::Mat image = load_legacy_image(*archive, meta);
+        return fit_image(image, image.cols, image.rows, width, height);
     }
 
-    // Try decompressing with increasing buffer size if needed
-    uLongf uncompressed_size = meta.length * 20;
-    std::vector<uchar> uncompressed;
+    int index = (meta.entry >= 0) ? meta.entry : archive->find_entry(static_cast<uint64_t>(meta.offset));
+    if (index < 0 || index >= archive->entry_count()) {
+        std::cerr << "No archive entry for puzzle: " << meta.name << std::endl;
+        return cv::Mat();
+    }
 
-    for (int attempt = 0; attempt < 3; ++attempt) {
-        uncompressed.resize(uncompressed_size);
-        int z_result = uncompress(uncompressed.data(), &uncompressed_size, compressed.data(), meta.length);
+    return load_record(*archive, index, meta, width, height);
+}
 
-        if (z_result == Z_OK) {
-            uncompressed.resize(uncompressed_size);
-            return cv::imdecode(uncompressed, cv::IMREAD_COLOR);
+cv::Mat Puzzle::load_preview(const std::string& dat_path, const PuzzleMeta& meta, int width, int height) {
+    const PuzzleArchive* archive = PuzzleArchive::find(dat_path);
+    int level = (archive && meta.entry >= 0) ? archive->find_mip(meta.entry, width, height) : -1;
+    if (level >= 0) {
+        cv::Mat preview = load_record(*archive, archive->mip_record(meta.entry, level), meta, width, height);
+        if (!preview.empty()) {
+            return preview;
         }
-        uncompressed_size *= 2;
     }
 
-    std::cerr << "Decompression failed for puzzle: " << meta.name << std::endl;
-    return cv::Mat();
+    // Archives without mip levels: a reduced decode of the full image
+    return load_image(dat_path, meta, width, height);
 }
 
-Puzzle::Puzzle(const PuzzleMeta& meta, const std::map<std::string, bool>& solved_map) : session{} {
+PuzzleSession Puzzle::make_session(const std::string& dat_path, const PuzzleMeta& meta) {
+    PuzzleSession session{};
     session.meta = meta;
     session.puzzle_key = meta.name + "|" + meta.artist;
-    session.solved = solved_map.count(session.puzzle_key) ? solved_map.at(session.puzzle_key) : false;
+    session.solved = false;
 
-    cv::Mat image_original = load_image(PUZZLE_DATA_FILE, meta);
+    cv::Mat image_original = load_image(dat_path, meta);
     if (image_original.empty()) {
         throw std::runtime_error("Image load failed");
     }
@@ -88,9 +228,16 @@ Puzzle::Puzzle(const PuzzleMeta& meta, const std::map<std::string, bool>& solved
     session.layout = make_puzzle_layout(image_original, num_blocks, num_blocks);
     session.blocks = make_blocks(session.layout.cols, session.layout.rows, session.layout.block_width, session.layout.block_height);
 
-    int total_blocks = num_blocks * num_blocks;
-    session.perm.resize(total_blocks);
-    shuffle_permutation(session.perm, num_blocks, num_blocks, session.empty_idx, std::max(6, 2 * (total_blocks - 1)));
+    session.board = shuffle_board(num_blocks, num_blocks);
+    return session;
+}
+
+Puzzle::Puzzle(const PuzzleMeta& meta, const std::map<std::string, bool>& solved_map)
+    : Puzzle(make_session(PUZZLE_DATA_FILE, meta), solved_map) {
+}
+
+Puzzle::Puzzle(PuzzleSession prepared, const std::map<std::string, bool>& solved_map) : session(std::move(prepared)) {
+    session.solved = solved_map.count(session.puzzle_key) ? solved_map.at(session.puzzle_key) : false;
 }
 
 // Add static mouse callback for puzzle sliding
@@ -112,11 +259,8 @@ void Puzzle::on_mouse(int event, int x, int y, int /*flags*/, void* userdata) {
         return;
     }
 
-    // Try to swap
+    // Try to swap; the play loop redraws once the move is made
     Puzzle::swap_block(bx, by, *state);
-
-    // Redraw
-    cv::imshow(WIN_NAME, state->image_altered);
 }
 
 void Puzzle::play(std::map<std::string, bool>& solved_map, int& last_page, App* app_cb_userdata) {
@@ -128,11 +272,10 @@ void Puzzle::play(std::map<std::string, bool>& solved_map, int& last_page, App*
     }
 
     cv::Mat image_altered = session.layout.padded.clone();
-    fill_image_from_permutation(image_altered, session.layout.padded, session.perm, num_blocks, num_blocks, session.layout.block_width, session.layout.block_height);
+    fill_image_from_permutation(image_altered, session.layout.padded, session.board.perm(), num_blocks, num_blocks, session.layout.block_width, session.layout.block_height);
 
-    session.empty_idx = static_cast<int>(std::distance(session.perm.begin(), std::find(session.perm.begin(), session.perm.end(), 0)));
-    int empty_x = (session.empty_idx % num_blocks) * session.layout.block_width;
-    int empty_y = (session.empty_idx / num_blocks) * session.layout.block_height;
+    int empty_x = (session.board.blank() % num_blocks) * session.layout.block_width;
+    int empty_y = (session.board.blank() / num_blocks) * session.layout.block_height;
 
     MouseState mouse_state{
         session.layout.block_width,
@@ -144,31 +287,80 @@ void Puzzle::play(std::map<std::string, bool>& solved_map, int& last_page, App*
         image_altered,
         session.layout.padded,
         session.blocks,
-        &session.perm,
+        &session.board,
         session.solved,
         session.puzzle_key
     };
 
-    // Use Puzzle's static callback and pass MouseState as userdata
+    // The event loop hands clicks to Puzzle's static callback with MouseState as userdata
     cv::namedWindow(WIN_NAME, cv::WINDOW_AUTOSIZE);
     cv::resizeWindow(WIN_NAME, image_altered.cols, image_altered.rows);
-    cv::setMouseCallback(WIN_NAME, Puzzle::on_mouse, &mouse_state);
-    cv::imshow(WIN_NAME, image_altered);
+    // The hint search runs only while hints are shown: an unbounded 4x4 or 5x5 search would
+    // otherwise keep a core busy for a player who never asks for one
+    std::unique_ptr<HintEngine> hints;
+    bool show_hint = false;
+    int shown_hint = -1;
+
+    EventLoop loop(WIN_NAME);
+    loop.present(image_altered);
 
     while (true) {
-        int key = cv::waitKey(1);
-        if (cv::getWindowProperty(WIN_NAME, cv::WND_PROP_VISIBLE) < 1) {
+        // Only poll the worker, never wait for it
+        int hint = (hints && !mouse_state.solved) ? hints->hint() : -1;
+        if (hint != shown_hint) {
+            shown_hint = hint;
+            loop.invalidate();
+        }
+
+        if (loop.dirty() && !loop.pending()) {
+            if (shown_hint >= 0) {
+                cv::Mat display = image_altered.clone();
+                draw_hint(display, shown_hint, num_blocks, session.layout.block_width, session.layout.block_height);
+                loop.present(display);
+            }
+            else {
+                loop.present(image_altered);
+            }
+        }
+
+        // Sleeps until input arrives, or wakes once a frame while a requested hint is still being searched
+        bool awaiting_hint = show_hint && !mouse_state.solved && hint < 0;
+        UiEvent event;
+        if (!loop.next(event, awaiting_hint ? EventLoop::FRAME_MS : EventLoop::FOREVER)) {
+            continue;
+        }
+
+        if (event.type == UiEvent::CLOSED) {
             return;
         }
 
-        if (key == 27 || (mouse_state.solved && key == cv::EVENT_LBUTTONDOWN)) {
-            break;
+        if (event.type == UiEvent::KEY) {
+            int key = event.code;
+            if (key == 27 || (mouse_state.solved && key == cv::EVENT_LBUTTONDOWN)) {
+                break;
+            }
+            if (key == 'h' || key == 'H') {
+                show_hint = !show_hint;
+                hints = (show_hint && !mouse_state.solved) ? std::make_unique<HintEngine>(session.board.perm(), num_blocks, num_blocks) : nullptr;
+                mouse_state.hints = hints.get();
+            }
+            continue;
         }
 
-        if (mouse_state.perm && is_solved(*mouse_state.perm) && !session.solved) {
+        // Only a move can solve the board, so it is checked once per move rather than every frame
+        int blank_x = empty_x, blank_y = empty_y;
+        Puzzle::on_mouse(event.code, event.x, event.y, event.flags, &mouse_state);
+        if (empty_x == blank_x && empty_y == blank_y) {
+            continue;
+        }
+        loop.invalidate();
+
+        if (mouse_state.board && mouse_state.board->is_solved() && !session.solved) {
             app_cb_userdata->handle_puzzle_solved(mouse_state, solved_map, last_page);
             session.solved = true;
             mouse_state.solved = true;
+            mouse_state.hints = nullptr;
+            hints.reset();
         }
     }
 
@@ -220,19 +412,6 @@ void Puzzle::fill_image_from_permutation(cv::Mat& image_altered, const cv::Mat&
     }
 }
 
-int Puzzle::permutation_manhattan_distance(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y) {
-    int dist = 0;
-    for (size_t idx = 0; idx < perm.size(); ++idx) {
-        if (perm[idx] == 0) {
-            continue;
-        }
-
-        dist += std::abs(static_cast<int>(idx % num_blocks_x) - perm[idx] % num_blocks_x);
-        dist += std::abs(static_cast<int>(idx / num_blocks_x) - perm[idx] / num_blocks_x);
-    }
-    return dist;
-}
-
 void Puzzle::swap_block(int x, int y, MouseState &state) {
     if (!Util::is_adjacent(x, y, state.empty_x, state.empty_y, state.block_width, state.block_height)) {
         return;
@@ -251,73 +430,39 @@ void Puzzle::swap_block(int x, int y, MouseState &state) {
     state.image_altered(to_rect).copyTo(state.image_altered(from_rect));
     temp.copyTo(state.image_altered(to_rect));
 
-    if (state.perm) {
+    if (state.board) {
         int num_blocks_x = state.cols / state.block_width;
         int from_idx = (y / state.block_height) * num_blocks_x + (x / state.block_width);
-        int to_idx = (state.empty_y / state.block_height) * num_blocks_x + (state.empty_x / state.block_width);
-        std::swap((*state.perm)[from_idx], (*state.perm)[to_idx]);
+        state.board->move(from_idx);
+
+        // Restart the hint search from the new permutation
+        if (state.hints) {
+            state.hints->update(state.board->perm());
+        }
     }
 
     state.empty_x = x; state.empty_y = y;
 }
 
-bool Puzzle::is_solved(const std::vector<int>& perm) {
-    for (size_t i = 1; i < perm.size(); ++i) {
-        if ((int)i != perm[i]) {
-            return false;
-        }
-    }
-    return true;
+void Puzzle::draw_hint(cv::Mat& image, int cell, int num_blocks_x, int block_width, int block_height) {
+    int x = (cell % num_blocks_x) * block_width;
+    int y = (cell / num_blocks_x) * block_height;
+    cv::Rect rect = cv::Rect(x, y, block_width, block_height) & cv::Rect(0, 0, image.cols, image.rows);
+    cv::rectangle(image, rect, cv::Scalar(255, 255, 80), 4);
 }
 
-std::vector<int> Puzzle::get_empty_neighbors(int empty_idx, int num_blocks_x, int num_blocks_y, const std::vector<int>& perm, bool avoid_zero) {
-    std::vector<int> neighbors;
-    int ex = empty_idx % num_blocks_x;
-    int ey = empty_idx / num_blocks_x;
-
-    // Lambda to add neighbor if in bounds and (optionally) not zero
-    auto try_add = [&](int nx, int ny) {
-        if (nx >= 0 && nx < num_blocks_x && ny >= 0 && ny < num_blocks_y) {
-            int nidx = ny * num_blocks_x + nx;
-            if (!avoid_zero || perm[nidx] != 0) {
-                neighbors.push_back(nidx);
-            }
-        }
-    };
-
-    try_add(ex - 1, ey); // left
-    try_add(ex + 1, ey); // right
-    try_add(ex, ey - 1); // up
-    try_add(ex, ey + 1); // down
-
-    return neighbors;
+// Optimal sequence of board indices to slide into the blank, empty if the permutation is unsolvable
+std::vector<int> Puzzle::solve(const Board& board) {
+    return Solver::solve(board.perm(), board.cols(), board.rows()).moves;
 }
 
-void Puzzle::shuffle_permutation(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int& empty_idx, int min_challenge) {
-    int total_blocks = num_blocks_x * num_blocks_y;
-    cv::RNG rng((unsigned)cv::getTickCount());
-    int challenge = 0;
+// Uniformly random solvable board with a minimum Manhattan distance
+Board Puzzle::shuffle_board(int num_blocks_x, int num_blocks_y) {
+    thread_local Shuffler shuffler;
 
-    do {
-        std::iota(perm.begin(), perm.end(), 0);
-        empty_idx = 0;
-        int shuffle_moves = rng.uniform(30, 100);
-
-        for (int i = 0; i < shuffle_moves; ++i) {
-            bool avoid_zero = (i > 0);
-            auto neighbors = get_empty_neighbors(empty_idx, num_blocks_x, num_blocks_y, perm, avoid_zero);
-            if (neighbors.empty()) {
-                break;
-            }
-
-            int nidx = neighbors[rng.uniform(0, static_cast<int>(neighbors.size()))];
-            std::swap(perm[empty_idx], perm[nidx]);
-            empty_idx = nidx;
-        }
-
-        challenge = permutation_manhattan_distance(perm, num_blocks_x, num_blocks_y);
-    }
-    while (challenge < min_challenge);
+    std::vector<int> perm(num_blocks_x * num_blocks_y);
+    shuffler.shuffle(perm, num_blocks_x, num_blocks_y, Shuffler::default_challenge(num_blocks_x, num_blocks_y));
+    return Board(perm, num_blocks_x, num_blocks_y);
 }
 
 std::vector<cv::Rect> Puzzle::make_blocks(int cols, int rows, int block_width, int block_height) {
@@ -14,13 +14,23 @@ class App;
 class Puzzle {
 public:
     static std::vector<PuzzleMeta> load_meta(const std::string& json_path);
-    static cv::Mat load_image(const std::string& dat_path, const PuzzleMeta& meta);
+    // Links each entry to its record in a version 2 archive index, which also gives the image size without decoding
+    static void resolve_entries(const std::string& dat_path, std::vector<PuzzleMeta>& metas);
+    // Full-resolution image, or when width and height are given, the image fitted into them. JPEG
+    // entries are then decoded at the smallest libjpeg reduction (1/2, 1/4, 1/8) that still covers the target.
+    static cv::Mat load_image(const std::string& dat_path, const PuzzleMeta& meta, int width = 0, int height = 0);
+    // Smallest stored mip level covering width x height, or the full image decoded to fit when the archive has none
+    static cv::Mat load_preview(const std::string& dat_path, const PuzzleMeta& meta, int width, int height);
+    // Decoded, padded and shuffled puzzle, ready to play; throws if the image cannot be loaded
+    static PuzzleSession make_session(const std::string& dat_path, const PuzzleMeta& meta);
     
 public:
     PuzzleSession session;
 
 public:
     explicit Puzzle(const PuzzleMeta& meta, const std::map<std::string, bool>& solved_map);
+    // Takes over a session prepared ahead of time, e.g. by the SessionPrefetcher
+    explicit Puzzle(PuzzleSession prepared, const std::map<std::string, bool>& solved_map);
 
 public:
     void play(std::map<std::string, bool>& solved_map, int& last_page, class App* app_cb_userdata);
@@ -30,12 +40,11 @@ public:
 
     static void fill_image_from_permutation(cv::Mat& image_altered, const cv::Mat& image_original, const std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int block_width, int block_height);
 
-    static int permutation_manhattan_distance(const std::vector<int>& perm, int num_blocks_x, int num_blocks_y);
     static void swap_block(int x, int y, MouseState &state);
-    static bool is_solved(const std::vector<int>& perm);
+    static void draw_hint(cv::Mat& image, int cell, int num_blocks_x, int block_width, int block_height);
+    static std::vector<int> solve(const Board& board);
     static void on_mouse(int event, int x, int y, int flags, void* userdata);
-    static std::vector<int> get_empty_neighbors(int empty_idx, int num_blocks_x, int num_blocks_y, const std::vector<int>& perm, bool avoid_zero);
-    static void shuffle_permutation(std::vector<int>& perm, int num_blocks_x, int num_blocks_y, int& empty_idx, int min_challenge);
+    static Board shuffle_board(int num_blocks_x, int num_blocks_y);
     static std::vector<cv::Rect> make_blocks(int cols, int rows, int block_width, int block_height);
     static PuzzleLayout make_puzzle_layout(const cv::Mat& image, int num_blocks_x, int num_blocks_y);
 };
@@ -0,0 +1,121 @@
+#include "session_prefetcher.hpp"
+
+#include "puzzle.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+
+SessionPrefetcher::SessionPrefetcher(const std::string& dat_path, const std::vector<PuzzleMeta>& metas)
+    : dat_path(dat_path), metas(metas) {
+    for (int i = 0; i < THREADS; ++i) {
+        workers.emplace_back(&SessionPrefetcher::worker_loop, this);
+    }
+}
+
+SessionPrefetcher::~SessionPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool SessionPrefetcher::wanted(int index) const {
+    return focused >= 0 && std::abs(index - focused) <= 1;
+}
+
+void SessionPrefetcher::focus(int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    focused = index;
+
+    // Jobs still running outside the window are kept until they finish and a later focus() drops them
+    std::erase_if(queue, [this](int i) { return !wanted(i); });
+    std::erase_if(jobs, [this](const auto& item) { return !wanted(item.first) && !item.second.running; });
+
+    for (int i : {index + 1, index - 1}) {
+        if (i >= 0 && i < static_cast<int>(metas.size()) && !jobs.contains(i)) {
+            jobs[i];
+            queue.push_back(i);
+        }
+    }
+
+    // The current page goes ahead of its neighbours, even if it was queued as one of them
+    if (index >= 0 && index < static_cast<int>(metas.size())) {
+        if (!jobs.contains(index)) {
+            jobs[index];
+            queue.push_front(index);
+        }
+        else if (auto q = std::find(queue.begin(), queue.end(), index); q != queue.end()) {
+            queue.erase(q);
+            queue.push_front(index);
+        }
+    }
+    wake.notify_all();
+}
+
+PuzzleSession SessionPrefetcher::take(int index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = jobs.find(index);
+
+    if (it != jobs.end() && it->second.running) {
+        done.wait(lock, [&] { return !jobs.at(index).running; });
+        it = jobs.find(index);
+    }
+
+    if (it != jobs.end() && it->second.session) {
+        PuzzleSession session = std::move(*it->second.session);
+        jobs.erase(it);
+        return session;
+    }
+
+    // Not started yet or failed: build it here, which also reports the error to the caller
+    if (it != jobs.end()) {
+        std::erase(queue, index);
+        jobs.erase(it);
+    }
+    lock.unlock();
+    return Puzzle::make_session(dat_path, metas.at(index));
+}
+
+void SessionPrefetcher::worker_loop() {
+    while (true) {
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+
+            index = queue.front();
+            queue.pop_front();
+            jobs[index].running = true;
+        }
+
+        std::optional<PuzzleSession> session;
+        try {
+            session = Puzzle::make_session(dat_path, metas[index]);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Failed to prefetch puzzle " << metas[index].name << ": " << e.what() << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Job& job = jobs[index];
+            job.running = false;
+            job.session = std::move(session);
+        }
+        done.notify_all();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "main.hpp"
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <condition_variable>
+
+// Prepares the puzzle sessions around the menu page on a small thread pool: the image of the
+// current, next and previous puzzle is decoded, padded into blocks and shuffled ahead of time,
+// so opening one of them or flipping to it shows no decode stall.
+class SessionPrefetcher {
+public:
+    static constexpr int THREADS = 2;
+
+    SessionPrefetcher(const std::string& dat_path, const std::vector<PuzzleMeta>& metas);
+    ~SessionPrefetcher();
+
+    SessionPrefetcher(const SessionPrefetcher&) = delete;
+    SessionPrefetcher& operator=(const SessionPrefetcher&) = delete;
+
+    // Prefetches index and its neighbours, and drops sessions prepared for other pages
+    void focus(int index);
+
+    // The prepared session, waiting for it if it is being built; built on the calling thread
+    // if it was never requested. Throws like Puzzle::make_session when the image is unusable.
+    PuzzleSession take(int index);
+
+private:
+    struct Job {
+        std::optional<PuzzleSession> session;
+        bool running = false;
+    };
+
+    bool wanted(int index) const;
+    void worker_loop();
+
+private:
+    std::string dat_path;
+    std::vector<PuzzleMeta> metas;
+
+    std::mutex mutex;
+    std::condition_variable wake;           // workers: a job was queued or the pool stops
+    std::condition_variable done;           // take(): a job finished
+
+    std::map<int, Job> jobs;
+    std::deque<int> queue;
+    int focused = -1;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,55 @@
+#include "startup.hpp"
+
+#include "state.hpp"
+#include "puzzle.hpp"
+#include "core/pattern_db.hpp"
+#include "core/startup_trace.hpp"
+#include "core/puzzle_archive.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <future>
+#include <iostream>
+#include <algorithm>
+
+
+bool Startup::run() {
+    StartupTrace::mark("startup");
+
+    // I/O stage: everything that does not need the catalog, next to the JSON parse
+    auto io = std::async(std::launch::async, [this] {
+        PuzzleArchive::find(data_file);
+        StartupTrace::mark("archive mapped");
+
+        PatternDB::load_all(pattern_db_dir);
+        StartupTrace::mark("pattern databases mapped");
+
+        State::load(solved_indices, last_page);
+        StartupTrace::mark("state loaded");
+    });
+
+    // Leaving through an exception still waits for the I/O stage in the future's destructor
+    metas = Puzzle::load_meta(meta_file);
+    StartupTrace::mark("metadata parsed");
+    io.get();
+
+    Puzzle::resolve_entries(data_file, metas);
+    if (metas.empty()) {
+        std::cerr << "No puzzles found in " << meta_file << std::endl;
+        return false;
+    }
+    last_page = std::clamp(last_page, 0, static_cast<int>(metas.size()) - 1);
+
+    // Decode stage: the pools start on the page the menu opens at
+    previews = std::make_unique<PreviewCache>(data_file, thumbnail_file, metas, PREVIEW_CACHE_BUDGET, PREVIEW_MAX_WIDTH, PREVIEW_MAX_HEIGHT);
+    previews->get(last_page);
+    previews->request(last_page + 1);
+    previews->request(last_page - 1);
+
+    sessions = std::make_unique<SessionPrefetcher>(data_file, metas);
+    sessions->focus(last_page);
+
+    StartupTrace::mark("pipeline started");
+    return true;
+}
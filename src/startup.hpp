@@ -0,0 +1,31 @@
+#pragma once
+
+#include "main.hpp"
+#include "preview_cache.hpp"
+#include "session_prefetcher.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Staged startup pipeline. The catalog JSON is parsed on the calling thread while the archive,
+// the pattern databases and the saved state are opened on another; the preview and session
+// pools then start on the entry at last_page first, so the menu can show it as soon as it is
+// decoded. Milestones go to StartupTrace.
+class Startup {
+public:
+    std::string meta_file = PUZZLE_META_FILE;
+    std::string data_file = PUZZLE_DATA_FILE;
+    std::string thumbnail_file = PREVIEW_THUMBNAIL_FILE;
+    std::string pattern_db_dir = PATTERN_DB_DIR;
+
+    std::vector<PuzzleMeta> metas;
+    std::vector<int> solved_indices;
+    int last_page = 0;
+
+    std::unique_ptr<PreviewCache> previews;
+    std::unique_ptr<SessionPrefetcher> sessions;
+
+    // False if the catalog is empty; throws like Puzzle::load_meta when it cannot be read
+    bool run();
+};
@@ -0,0 +1,170 @@
+#include "thumbnail_cache.hpp"
+
+#include "core/puzzle_archive.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+
+#include <zlib.h>
+#include <opencv2/opencv.hpp>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr char THUMBNAIL_CACHE_MAGIC[4] = {'R', 'V', 'T', 'C'};
+constexpr uint32_t THUMBNAIL_CACHE_VERSION = 1;
+
+bool archive_signature(const std::string& dat_path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = fs::file_size(dat_path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = static_cast<int64_t>(fs::last_write_time(dat_path, ec).time_since_epoch().count());
+    return !ec;
+}
+
+} // namespace
+
+
+uint32_t ThumbnailCache::entry_key(const std::string& dat_path, const PuzzleMeta& meta) {
+    const PuzzleArchive* archive = PuzzleArchive::find(dat_path);
+    if (archive && meta.entry >= 0 && meta.entry < archive->entry_count()) {
+        return archive->entry(meta.entry).crc32;
+    }
+
+    int64_t location[2] = {meta.offset, meta.length};
+    return static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(location), sizeof(location)));
+}
+
+void ThumbnailCache::open(const std::string& path, const std::string& dat_path, const std::vector<PuzzleMeta>& metas, int width, int height) {
+    this->path = path;
+    this->width = width;
+    this->height = height;
+    mapped.assign(metas.size(), cv::Mat());
+    added.clear();
+    file.close();
+
+    keys.clear();
+    for (const auto& meta : metas) {
+        keys.push_back(entry_key(dat_path, meta));
+    }
+
+    if (!archive_signature(dat_path, archive_size, archive_mtime) || !file.open(path)) {
+        return;
+    }
+    if (file.size() < sizeof(ThumbnailCacheHeader)) {
+        file.close();
+        return;
+    }
+
+    // Anything stale or malformed is ignored and replaced by the next save()
+    const auto* header = reinterpret_cast<const ThumbnailCacheHeader*>(file.data());
+    uint64_t records_end = sizeof(ThumbnailCacheHeader) + static_cast<uint64_t>(header->count) * sizeof(ThumbnailCacheRecord);
+    if (std::memcmp(header->magic, THUMBNAIL_CACHE_MAGIC, 4) != 0 ||
+        header->version != THUMBNAIL_CACHE_VERSION || header->max_width != width || header->max_height != height ||
+        header->archive_size != archive_size || header->archive_mtime != archive_mtime || records_end > file.size()) {
+        file.close();
+        return;
+    }
+
+    std::unordered_map<uint32_t, cv::Mat> by_key;
+    const auto* records = reinterpret_cast<const ThumbnailCacheRecord*>(file.data() + sizeof(ThumbnailCacheHeader));
+    for (uint32_t i = 0; i < header->count; ++i) {
+        const ThumbnailCacheRecord& r = records[i];
+        uint64_t bytes = static_cast<uint64_t>(r.width) * r.height * 3;
+        if (r.width == 0 || r.height == 0 || r.offset > file.size() || bytes > file.size() - r.offset) {
+            continue;
+        }
+        by_key[r.key] = cv::Mat(r.height, r.width, CV_8UC3, const_cast<uint8_t*>(file.data() + r.offset));
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto it = by_key.find(keys[i]);
+        if (it != by_key.end()) {
+            mapped[i] = it->second;
+        }
+    }
+}
+
+cv::Mat ThumbnailCache::find(int index) const {
+    return (index >= 0 && index < static_cast<int>(mapped.size())) ? mapped[index] : cv::Mat();
+}
+
+void ThumbnailCache::add(int index, const cv::Mat& image) {
+    if (index < 0 || index >= static_cast<int>(keys.size()) || image.empty() || image.type() != CV_8UC3) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    added[index] = image.isContinuous() ? image : image.clone();
+}
+
+bool ThumbnailCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (added.empty() || path.empty()) {
+        return true;
+    }
+
+    // One thumbnail per key, freshly decoded ones win over mapped ones
+    std::map<uint32_t, cv::Mat> thumbnails;
+    for (size_t i = 0; i < mapped.size(); ++i) {
+        if (!mapped[i].empty()) {
+            thumbnails[keys[i]] = mapped[i];
+        }
+    }
+    for (const auto& [index, image] : added) {
+        thumbnails[keys[index]] = image;
+    }
+
+    ThumbnailCacheHeader header{};
+    std::memcpy(header.magic, THUMBNAIL_CACHE_MAGIC, 4);
+    header.version = THUMBNAIL_CACHE_VERSION;
+    header.count = static_cast<uint32_t>(thumbnails.size());
+    header.max_width = static_cast<uint16_t>(width);
+    header.max_height = static_cast<uint16_t>(height);
+    header.archive_size = archive_size;
+    header.archive_mtime = archive_mtime;
+
+    std::vector<ThumbnailCacheRecord> records;
+    uint64_t offset = sizeof(ThumbnailCacheHeader) + thumbnails.size() * sizeof(ThumbnailCacheRecord);
+    for (const auto& [key, image] : thumbnails) {
+        records.push_back({offset, key, static_cast<uint16_t>(image.cols), static_cast<uint16_t>(image.rows)});
+        offset += image.total() * image.elemSize();
+    }
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(ThumbnailCacheRecord)));
+    for (const auto& [key, image] : thumbnails) {
+        out.write(reinterpret_cast<const char*>(image.data), static_cast<std::streamsize>(image.total() * image.elemSize()));
+    }
+    out.close();
+
+    // The old mapping must be released before the file can be replaced
+    thumbnails.clear();
+    mapped.assign(mapped.size(), cv::Mat());
+    added.clear();
+    file.close();
+
+    if (out) {
+        fs::rename(tmp_path, path, ec);
+    }
+    if (!out || ec) {
+        std::cerr << "Failed to write thumbnail cache: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
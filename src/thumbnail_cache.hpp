@@ -0,0 +1,66 @@
+#pragma once
+
+#include "main.hpp"
+#include "core/mapped_file.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+// res/cache/previews.bin: header, one record per thumbnail, then raw BGR pixels without row
+// padding. The header records the size and modification time of the archive it was built
+// from, so any change to puzzles.dat discards the whole cache.
+struct ThumbnailCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint16_t max_width, max_height;     // preview box the thumbnails were fitted into
+    uint64_t archive_size;
+    int64_t archive_mtime;
+};
+
+struct ThumbnailCacheRecord {
+    uint64_t offset;                    // byte offset of the pixels from the start of the file
+    uint32_t key;                       // entry CRC32 from the archive index, see ThumbnailCache::entry_key
+    uint16_t width, height;
+};
+
+static_assert(sizeof(ThumbnailCacheHeader) == 32 && sizeof(ThumbnailCacheRecord) == 16, "cache records must keep their on-disk size");
+
+// Decoded menu previews persisted across launches. A warm start maps the file and hands out
+// cv::Mat headers on the mapped pixels, so no preview is decompressed, decoded or resized.
+class ThumbnailCache {
+public:
+    // Maps path when it was written for the current dat_path and preview size, otherwise starts empty
+    void open(const std::string& path, const std::string& dat_path, const std::vector<PuzzleMeta>& metas, int width, int height);
+
+    // Thumbnail of the catalog entry, empty if it is not cached. The pixels are a read-only
+    // mapping and stay valid until save(): copy before modifying.
+    cv::Mat find(int index) const;
+
+    // Remembers a freshly decoded thumbnail for the next save(), thread-safe
+    void add(int index, const cv::Mat& image);
+
+    // Rewrites the file with every mapped and added thumbnail if anything was added
+    bool save();
+
+    // Content key of an entry: its CRC32 in a version 2 archive, otherwise a hash of its location
+    static uint32_t entry_key(const std::string& dat_path, const PuzzleMeta& meta);
+
+private:
+    std::string path;
+    uint64_t archive_size = 0;
+    int64_t archive_mtime = 0;
+    int width = 0, height = 0;
+
+    std::vector<uint32_t> keys;         // per catalog entry
+    MappedFile file;
+    std::vector<cv::Mat> mapped;        // per catalog entry, empty when not cached
+
+    std::mutex mutex;
+    std::map<int, cv::Mat> added;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the ctest programs: a failed check prints its location and expression
+// and is counted, and main returns check::result() so ctest reports the program as failed.
+namespace check {
+
+inline int failures = 0;
+
+inline int result() {
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace check
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++check::failures; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long long check_a = static_cast<long long>(a), check_b = static_cast<long long>(b); \
+        if (check_a != check_b) { \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, check_a, check_b); \
+            ++check::failures; \
+        } \
+    } while (0)
@@ -0,0 +1,183 @@
+// Version 2 archive round trip: an archive with raw and zlib entries and a mip chain is written
+// to a temporary file and read back through PuzzleArchive, then one stored byte is corrupted
+// and the CRC check must reject exactly that record.
+
+#include "check.hpp"
+
+#include "../src/core/puzzle_archive.hpp"
+
+#include <span>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr int ENTRIES = 3;
+constexpr int MIPS = 2;
+
+struct TestRecord {
+    PuzzleArchiveEntry entry{};
+    std::vector<uint8_t> image;         // bytes after the codec is undone
+    std::vector<uint8_t> stored;
+};
+
+TestRecord make_record(std::mt19937& rng, size_t size, int width, int height, bool zlib) {
+    TestRecord record;
+    record.image.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        record.image[i] = static_cast<uint8_t>((i % 7 == 0) ? rng() : i / 64);     // compressible, not constant
+    }
+
+    if (zlib) {
+        uLongf stored_size = compressBound(static_cast<uLong>(size));
+        record.stored.resize(stored_size);
+        compress(record.stored.data(), &stored_size, record.image.data(), static_cast<uLong>(size));
+        record.stored.resize(stored_size);
+    }
+    else {
+        record.stored = record.image;
+    }
+
+    PuzzleArchiveEntry& e = record.entry;
+    e.stored_size = record.stored.size();
+    e.uncompressed_size = size;
+    e.crc32 = static_cast<uint32_t>(crc32(0L, record.stored.data(), static_cast<uInt>(record.stored.size())));
+    e.width = static_cast<uint16_t>(width);
+    e.height = static_cast<uint16_t>(height);
+    e.format = static_cast<uint8_t>(zlib ? ImageFormat::BGR : ImageFormat::JPEG);
+    e.codec = zlib ? CODEC_ZLIB : 0;
+    return record;
+}
+
+// Header, entry records, mip records, then each entry's data followed by its mips
+void write_archive(const fs::path& path, std::vector<TestRecord>& records) {
+    PuzzleArchiveHeader header{};
+    std::memcpy(header.magic, PUZZLE_ARCHIVE_MAGIC, 4);
+    header.version = PUZZLE_ARCHIVE_VERSION;
+    header.entry_count = ENTRIES;
+    header.mip_levels = MIPS;
+    header.index_offset = sizeof(PuzzleArchiveHeader);
+    header.data_offset = header.index_offset + records.size() * sizeof(PuzzleArchiveEntry);
+
+    uint64_t offset = header.data_offset;
+    for (int i = 0; i < ENTRIES; ++i) {
+        records[i].entry.offset = offset;
+        offset += records[i].stored.size();
+        for (int level = 0; level < MIPS; ++level) {
+            TestRecord& mip = records[ENTRIES + i * MIPS + level];
+            mip.entry.offset = offset;
+            offset += mip.stored.size();
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& record : records) {
+        out.write(reinterpret_cast<const char*>(&record.entry), sizeof(PuzzleArchiveEntry));
+    }
+    for (int i = 0; i < ENTRIES; ++i) {
+        out.write(reinterpret_cast<const char*>(records[i].stored.data()), records[i].stored.size());
+        for (int level = 0; level < MIPS; ++level) {
+            const TestRecord& mip = records[ENTRIES + i * MIPS + level];
+            out.write(reinterpret_cast<const char*>(mip.stored.data()), mip.stored.size());
+        }
+    }
+}
+
+} // namespace
+
+
+int main() {
+    std::mt19937 rng(5);
+    std::vector<TestRecord> records;
+    for (int i = 0; i < ENTRIES; ++i) {
+        records.push_back(make_record(rng, 5000 + 1000 * i, 1280, 720, i % 2 == 1));
+    }
+    for (int i = 0; i < ENTRIES; ++i) {
+        records.push_back(make_record(rng, 900, 740, 416, false));
+        records.push_back(make_record(rng, 300, 370, 208, false));
+    }
+
+    fs::path path = fs::temp_directory_path() / "revision_test_archive.dat";
+    write_archive(path, records);
+
+    {
+        PuzzleArchive archive;
+        CHECK(archive.open(path.string()));
+        CHECK_EQ(archive.version(), 2);
+        CHECK_EQ(archive.entry_count(), ENTRIES);
+        CHECK_EQ(archive.mip_levels(), MIPS);
+        CHECK_EQ(archive.record_count(), ENTRIES * (1 + MIPS));
+
+        std::vector<uint8_t> buffer;
+        for (int r = 0; r < archive.record_count(); ++r) {
+            CHECK(archive.validate(r));
+            std::span<const uint8_t> bytes = archive.extract(r, buffer);
+            CHECK(std::vector<uint8_t>(bytes.begin(), bytes.end()) == records[r].image);
+
+            std::vector<uint8_t> exact(records[r].image.size());
+            CHECK(archive.extract_to(r, exact));
+            CHECK(exact == records[r].image);
+        }
+        CHECK(!archive.validate(archive.record_count()));
+
+        for (int i = 0; i < ENTRIES; ++i) {
+            CHECK_EQ(archive.find_entry(archive.entry(i).offset), i);
+            CHECK_EQ(archive.mip_record(i, 1), ENTRIES + i * MIPS + 1);
+            CHECK_EQ(archive.find_mip(i, 740, 416), 0);
+            CHECK_EQ(archive.find_mip(i, PREVIEW_MAX_WIDTH, PREVIEW_MAX_HEIGHT), 0);     // the menu's own box
+            CHECK_EQ(archive.find_mip(i, PREVIEW_MAX_WIDTH / 2, PREVIEW_MAX_HEIGHT / 2), 1);
+            CHECK_EQ(archive.find_mip(i, 300, 200), 1);
+            CHECK_EQ(archive.find_mip(i, 1000, 600), -1);
+        }
+        CHECK_EQ(archive.mip_record(0, MIPS), -1);
+    }
+
+    int fit_w = 0, fit_h = 0;
+    PuzzleArchive::fit_size(1280, 720, PREVIEW_MAX_WIDTH, PREVIEW_MAX_HEIGHT, fit_w, fit_h);
+    CHECK(fit_w == 740 && fit_h == 416);
+    PuzzleArchive::fit_size(600, 900, PREVIEW_MAX_WIDTH, PREVIEW_MAX_HEIGHT, fit_w, fit_h);
+    CHECK(fit_w == 320 && fit_h == 480);
+
+    // Flip one stored byte of the zlib entry: only that record fails its CRC
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(records[1].entry.offset + 10));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x40);
+        file.seekp(static_cast<std::streamoff>(records[1].entry.offset + 10));
+        file.write(&byte, 1);
+    }
+    {
+        PuzzleArchive archive;
+        CHECK(archive.open(path.string()));
+        std::vector<uint8_t> buffer;
+        CHECK(archive.validate(0));
+        CHECK(!archive.validate(1));
+        CHECK(archive.extract(1, buffer).empty());
+        CHECK(archive.validate(2));
+    }
+
+    // Anything without the magic is a legacy archive without an index
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "\x78\x9c legacy";
+        PuzzleArchive archive;
+        CHECK(archive.open(path.string()));
+        CHECK_EQ(archive.version(), 1);
+        CHECK_EQ(archive.entry_count(), 0);
+    }
+
+    fs::remove(path);
+    return check::result();
+}
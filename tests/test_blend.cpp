@@ -0,0 +1,48 @@
+// Coverage blending: every kernel the CPU supports must write exactly the bytes of the scalar
+// kernel, including the short tails the vector kernels handle through a padded copy, and must
+// leave the bytes around the blended rectangle alone.
+
+#include "check.hpp"
+
+#include "../src/core/blend.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdint>
+
+
+int main() {
+    std::mt19937 rng(22);
+    constexpr int HEIGHT = 5, MARGIN = 3;
+
+    for (auto kernel : {Blend::Kernel::SSE41, Blend::Kernel::AVX2}) {
+        if (!Blend::supported(kernel)) {
+            continue;
+        }
+        for (int channels = 1; channels <= 4; ++channels) {
+            for (int width = 1; width <= 80; ++width) {
+                size_t step = static_cast<size_t>(width + 2 * MARGIN) * channels;
+                std::vector<uint8_t> image(step * HEIGHT), coverage(width * HEIGHT);
+                for (auto& b : image) b = static_cast<uint8_t>(rng());
+                for (auto& b : coverage) b = static_cast<uint8_t>(rng() % 4 == 0 ? 255 * (rng() % 2) : rng());
+                uint8_t color[4] = {static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 255};
+
+                std::vector<uint8_t> expected = image, actual = image;
+                Blend::coverage(Blend::Kernel::SCALAR, expected.data() + MARGIN * channels, step, channels,
+                                coverage.data(), width, width, HEIGHT, color);
+                Blend::coverage(kernel, actual.data() + MARGIN * channels, step, channels,
+                                coverage.data(), width, width, HEIGHT, color);
+                CHECK(actual == expected);
+            }
+        }
+    }
+
+    // Full coverage paints the color, none leaves the pixel
+    uint8_t pixel[4] = {10, 20, 30, 0}, color[4] = {200, 100, 50, 255}, full = 255, none = 0;
+    Blend::coverage(pixel, 4, 4, &none, 1, 1, 1, color);
+    CHECK(pixel[0] == 10 && pixel[3] == 0);
+    Blend::coverage(pixel, 4, 4, &full, 1, 1, 1, color);
+    CHECK(pixel[0] == 200 && pixel[1] == 100 && pixel[2] == 50 && pixel[3] == 255);
+
+    return check::result();
+}
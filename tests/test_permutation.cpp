@@ -0,0 +1,80 @@
+// Lehmer rank/unrank round trips up to the largest rankable size, and incremental Zobrist
+// hashes and ranks of boards against the values recomputed from scratch.
+
+#include "check.hpp"
+
+#include "../src/core/board.hpp"
+#include "../src/core/shuffler.hpp"
+#include "../src/core/permutation.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+
+
+int main() {
+    std::mt19937_64 rng(3);
+
+    for (int n = 1; n <= Permutation::MAX_RANK_SIZE; ++n) {
+        std::vector<int> perm(n);
+        std::iota(perm.begin(), perm.end(), 0);
+        CHECK_EQ(Permutation::rank(perm), 0);
+
+        std::vector<int> reversed(perm.rbegin(), perm.rend());
+        CHECK(Permutation::rank(reversed) == Permutation::factorial(n) - 1);
+
+        for (int i = 0; i < 200; ++i) {
+            std::shuffle(perm.begin(), perm.end(), rng);
+            uint64_t idx = Permutation::rank(perm);
+            CHECK(idx < Permutation::factorial(n));
+            CHECK(Permutation::unrank(idx, n) == perm);
+        }
+    }
+
+    // Every rank of a small size is hit exactly once, in lexicographic order
+    std::vector<int> perm(6);
+    std::iota(perm.begin(), perm.end(), 0);
+    uint64_t expected = 0;
+    do {
+        CHECK(Permutation::rank(perm) == expected++);
+    } while (std::next_permutation(perm.begin(), perm.end()));
+
+    // Incremental hashes through random walks on the grid sizes the game uses
+    for (int size : {3, 4, 5}) {
+        std::vector<int> tiles(size * size);
+        Shuffler(size).uniform(tiles, size, size);
+        Board board(tiles, size, size);
+
+        for (int step = 0; step < 2000; ++step) {
+            int cells[4];
+            int count = board.legal_moves(cells);
+            board.move(cells[rng() % count]);
+            CHECK(board.hash() == Zobrist::hash(board.perm()));
+            if (board.size() <= Permutation::MAX_RANK_SIZE) {
+                CHECK(board.rank() == Permutation::rank(board.perm()));
+            }
+        }
+    }
+
+    // Past MAX_RANK_SIZE the rank would overflow: rank, unrank and Board::rank refuse
+    auto throws = [](auto fn) {
+        try {
+            fn();
+        }
+        catch (const std::out_of_range&) {
+            return true;
+        }
+        return false;
+    };
+    std::vector<int> large(Permutation::MAX_RANK_SIZE + 1);
+    std::iota(large.begin(), large.end(), 0);
+    CHECK(throws([&] { Permutation::rank(large); }));
+    CHECK(throws([&] { Permutation::unrank(0, Permutation::MAX_RANK_SIZE + 1); }));
+    CHECK(throws([&] { Board(5, 5).rank(); }));
+    CHECK(!throws([&] { Board(5, 4).rank(); }));
+
+    return check::result();
+}
@@ -0,0 +1,162 @@
+// Optimality of the solver: 3x3 heuristics against the exact distance table, 4x4 lengths with
+// and without the pattern database (generated here into a temporary directory), the known
+// optimal lengths of Korf's first three instances, and parallel against sequential search.
+
+#include "check.hpp"
+
+#include "../src/core/board.hpp"
+#include "../src/core/solver.hpp"
+#include "../src/core/shuffler.hpp"
+#include "../src/core/pattern_db.hpp"
+#include "../src/core/distance_table.hpp"
+
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+// The moves are legal and end on the solved board
+bool solves(const std::vector<int>& perm, int cols, int rows, const std::vector<int>& moves) {
+    Board board(perm, cols, rows);
+    for (int cell : moves) {
+        if (!board.move(cell)) {
+            return false;
+        }
+    }
+    return board.is_solved();
+}
+
+void heuristic_below_exact_3x3() {
+    const DistanceTable* table = DistanceTable::find(3, 3);
+    CHECK(table != nullptr);
+    if (!table) {
+        return;
+    }
+
+    std::vector<int> perm(9);
+    std::iota(perm.begin(), perm.end(), 0);
+    int reachable = 0;
+    do {
+        int distance = table->distance(perm);
+        if (distance < 0) {
+            continue;
+        }
+        ++reachable;
+        int h = Solver::heuristic(perm, 3, 3);
+        if (h > distance || (h % 2) != (distance % 2)) {
+            CHECK(h <= distance && (h % 2) == (distance % 2));
+            return;
+        }
+    } while (std::next_permutation(perm.begin(), perm.end()));
+
+    CHECK_EQ(reachable, 181440);
+}
+
+void solutions_3x3() {
+    const DistanceTable* table = DistanceTable::find(3, 3);
+    Shuffler shuffler(7);
+    std::vector<int> perm(9);
+    for (int i = 0; i < 200; ++i) {
+        shuffler.uniform(perm, 3, 3);
+        SolveResult result = Solver::solve(perm, 3, 3);
+        CHECK(result.solved);
+        CHECK_EQ(result.moves.size(), table->distance(perm));
+        CHECK(solves(perm, 3, 3, result.moves));
+    }
+}
+
+std::vector<std::vector<int>> boards_4x4(int count, int min_moves, int max_moves) {
+    Shuffler shuffler(11);
+    std::vector<std::vector<int>> boards;
+    std::vector<int> perm(16);
+    while (static_cast<int>(boards.size()) < count) {
+        if (shuffler.with_length(perm, 4, 4, min_moves, max_moves) >= 0) {
+            boards.push_back(perm);
+        }
+    }
+    return boards;
+}
+
+// Parallel IDA* returns the same first solution as the sequential search
+void parallel_matches_sequential(const std::vector<std::vector<int>>& boards) {
+    for (const auto& perm : boards) {
+        SolveOptions sequential, parallel;
+        parallel.threads = 4;
+        SolveResult a = Solver::solve(perm, 4, 4, sequential);
+        SolveResult b = Solver::solve(perm, 4, 4, parallel);
+        CHECK(a.solved && b.solved);
+        CHECK(a.moves == b.moves);
+        CHECK(solves(perm, 4, 4, b.moves));
+    }
+}
+
+} // namespace
+
+
+// Vectors that do not describe the board are refused before any board is built from them
+void rejects_mismatched_boards() {
+    std::vector<int> perm(15);
+    std::iota(perm.begin(), perm.end(), 0);
+    CHECK_EQ(Solver::heuristic(perm, 4, 4), -1);
+    CHECK(!Solver::solve(perm, 4, 4).solved);
+
+    perm.push_back(15);
+    perm[3] = 7;
+    CHECK_EQ(Solver::heuristic(perm, 4, 4), -1);
+    CHECK_EQ(Solver::heuristic(perm, 5, 5), -1);
+
+    perm[3] = 3;
+    CHECK_EQ(Solver::heuristic(perm, 4, 4), 0);
+}
+
+int main() {
+    rejects_mismatched_boards();
+    heuristic_below_exact_3x3();
+    solutions_3x3();
+
+    // Lengths found with Manhattan distance and linear conflicts only
+    std::vector<std::vector<int>> boards = boards_4x4(12, 20, 36);
+    std::vector<size_t> lengths;
+    for (const auto& perm : boards) {
+        SolveResult result = Solver::solve(perm, 4, 4);
+        CHECK(result.solved && solves(perm, 4, 4, result.moves));
+        lengths.push_back(result.moves.size());
+    }
+    parallel_matches_sequential(boards);
+
+    fs::path dir = fs::temp_directory_path() / "revision_test_solver";
+    fs::create_directories(dir);
+    CHECK(PatternDB::generate((dir / PatternDB::file_name(4, 4)).string(), 4, 4, PatternDB::default_patterns(4, 4)));
+    PatternDB::load_all(dir.string());
+    CHECK(PatternDB::find(4, 4) != nullptr);
+
+    // An admissible pattern database never changes an optimal length
+    for (size_t i = 0; i < boards.size(); ++i) {
+        SolveResult result = Solver::solve(boards[i], 4, 4);
+        CHECK(result.solved && solves(boards[i], 4, 4, result.moves));
+        CHECK_EQ(result.moves.size(), lengths[i]);
+        CHECK(Solver::heuristic(boards[i], 4, 4) <= static_cast<int>(lengths[i]));
+    }
+
+    // Korf (1985), instances 1 to 3
+    const std::vector<std::pair<std::vector<int>, int>> korf = {
+        {{14, 13, 15, 7, 11, 12, 9, 5, 6, 0, 2, 1, 4, 8, 10, 3}, 57},
+        {{13, 5, 4, 10, 9, 12, 8, 14, 2, 3, 7, 1, 0, 15, 11, 6}, 55},
+        {{14, 7, 8, 2, 13, 11, 10, 4, 9, 12, 5, 0, 3, 6, 1, 15}, 59},
+    };
+    for (const auto& [perm, optimal] : korf) {
+        SolveResult result = Solver::solve(perm, 4, 4, {0, nullptr, 0, 0});
+        CHECK(result.solved && solves(perm, 4, 4, result.moves));
+        CHECK_EQ(result.moves.size(), optimal);
+    }
+    parallel_matches_sequential(boards_4x4(4, 40, 50));
+
+    fs::remove_all(dir);
+    return check::result();
+}
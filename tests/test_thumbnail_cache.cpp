@@ -0,0 +1,106 @@
+// Thumbnail cache persistence: thumbnails saved for one archive come back from the mapped file
+// pixel for pixel, and the whole cache is dropped once the archive or the preview size changes.
+
+#include "check.hpp"
+
+#include "../src/main.hpp"
+#include "../src/thumbnail_cache.hpp"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#include <opencv2/opencv.hpp>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr int WIDTH = 64, HEIGHT = 48;
+
+bool same_pixels(const cv::Mat& a, const cv::Mat& b) {
+    if (a.empty() || b.empty() || a.size() != b.size() || a.type() != b.type()) {
+        return false;
+    }
+    for (int y = 0; y < a.rows; ++y) {
+        if (std::memcmp(a.ptr(y), b.ptr(y), a.cols * a.elemSize()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_file(const fs::path& path, const std::string& contents) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+} // namespace
+
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "revision_test_thumbnail_cache";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string dat_path = (dir / "puzzles.dat").string();
+    std::string cache_path = (dir / "cache" / "previews.bin").string();
+
+    // Legacy archive: entries are keyed by their location
+    write_file(dat_path, std::string(4096, 'x'));
+    std::vector<PuzzleMeta> metas(3);
+    for (int i = 0; i < 3; ++i) {
+        metas[i].offset = i * 1000;
+        metas[i].length = 1000;
+    }
+
+    cv::Mat first(HEIGHT, WIDTH, CV_8UC3, cv::Scalar(10, 20, 30));
+    cv::Mat second(HEIGHT / 2, WIDTH, CV_8UC3);
+    cv::randu(second, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    {
+        ThumbnailCache cache;
+        cache.open(cache_path, dat_path, metas, WIDTH, HEIGHT);
+        CHECK(cache.find(0).empty());
+        cache.add(0, first);
+        cache.add(2, second(cv::Rect(0, 0, WIDTH, HEIGHT / 2)));
+        CHECK(cache.save());
+    }
+    {
+        ThumbnailCache cache;
+        cache.open(cache_path, dat_path, metas, WIDTH, HEIGHT);
+        CHECK(same_pixels(cache.find(0), first));
+        CHECK(cache.find(1).empty());
+        CHECK(same_pixels(cache.find(2), second));
+        CHECK(cache.find(3).empty());
+    }
+
+    // Reordered catalog: thumbnails follow their entry, not their index
+    {
+        std::vector<PuzzleMeta> reordered = {metas[2], metas[0]};
+        ThumbnailCache cache;
+        cache.open(cache_path, dat_path, reordered, WIDTH, HEIGHT);
+        CHECK(same_pixels(cache.find(0), second));
+        CHECK(same_pixels(cache.find(1), first));
+    }
+
+    // A different preview box discards the cache
+    {
+        ThumbnailCache cache;
+        cache.open(cache_path, dat_path, metas, WIDTH * 2, HEIGHT * 2);
+        CHECK(cache.find(0).empty());
+    }
+
+    // A rebuilt archive discards the cache
+    write_file(dat_path, std::string(8192, 'y'));
+    {
+        ThumbnailCache cache;
+        cache.open(cache_path, dat_path, metas, WIDTH, HEIGHT);
+        CHECK(cache.find(0).empty());
+        CHECK(cache.find(2).empty());
+    }
+
+    fs::remove_all(dir);
+    return check::result();
+}